@@ -119,6 +119,38 @@ unsigned fdp2CG(const Matrix& A, const Vector& b, Vector& x, Real epsilon) {
 	return k;
 }
 
+// Conjugate Gradient algorithm, returns the iteration number of convergence
+// the vector updates are fused: each element of x, r, and p is rounded once
+template<typename Matrix, typename Vector, typename Real>
+unsigned fusedCG(const Matrix& A, const Vector& b, Vector& x, Real epsilon) {
+	using namespace sw::universal;
+	// starting x is provided by calling context
+	unsigned k = 0;
+	size_t n = size(b);
+	Vector r = b;
+	Real error = mtl::two_norm(r);
+	Vector p = r;
+	Vector Ap(size(p)); // need to create the vector to be the same structure as p as the expression (A * p) doesn't do it
+	while (error > epsilon) {
+		sw::hprblas::matvec(Ap, A, p);   // Ap = A * p
+		Real alpha = fdp(r, r) / fdp(p, Ap);
+		sw::hprblas::faxpy(n, alpha, p, 1, x, 1);         // x = x + alpha * p
+		Vector r_prev = r;
+		sw::hprblas::faxpy(n, -alpha, Ap, 1, r, 1);       // r = r - alpha * Ap
+		Real beta = fdp(r, r) / fdp(r_prev, r_prev);
+		sw::hprblas::faxpby(n, Real(1), r, 1, beta, p, 1);   // p = r + beta * p
+		error = mtl::two_norm(r);
+		std::cout << "iteration: " << std::setw(4) << k
+			<< " alpha: " << std::setw(12) << alpha
+			<< " beta: " << std::setw(12) << beta
+			<< " error : " << error << std::endl;
+
+		++k;
+		if (k > 1.5* size(b)) break;
+	}
+	return k;
+}
+
 template<typename Real>
 void CGdriver(unsigned N, Real epsilon) {
 	using namespace std;
@@ -195,6 +227,32 @@ void fdp2CGdriver(unsigned N, sw::universal::posit<nbits, es> epsilon) {
 	cout << "exact error is: " << two_norm(error) << endl;
 }
 
+// CG with fdp applied to alpha/beta, to matvec A * p, and fused vector updates
+template<size_t nbits, size_t es>
+void fusedCGdriver(unsigned N, sw::universal::posit<nbits, es> epsilon) {
+	using namespace std;
+	using namespace mtl;
+	using Real = sw::universal::posit<nbits, es>;
+	using Matrix = mtl::dense2D<Real>;
+	using Vector = mtl::dense_vector<Real>;
+
+	Matrix A(N, N);
+	mat::laplacian_setup(A, N, 1);
+	//cout << A << endl;
+
+	Vector b(N), x(N), ones(N);
+	ones = Real(1);
+	b = A * ones;
+	x = Real(0.0);  // starting x
+	cout << b << endl;
+	unsigned k = fusedCG(A, b, x, epsilon);
+	cout << "solution: " << x << " at iteration: " << k << endl;
+
+	Vector error(N);
+	error = ones - x;
+	cout << "exact error is: " << two_norm(error) << endl;
+}
+
 // CG test program
 int main(int argc, char** argv)
 try {
@@ -234,6 +292,7 @@ try {
 		CGdriver(N, epsilon);
 		fdpCGdriver(N, epsilon);
 		fdp2CGdriver(N, epsilon);
+		fusedCGdriver(N, epsilon);
 	}
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,171 @@
+// carry_save_quire.cpp: verify the deferred-carry quire engine against the reference quire
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <random>
+// select the carry-save engine in the fused kernels
+#define HPRBLAS_CARRY_SAVE_QUIRE 1
+#include <hprblas>
+
+/*
+ carry_save_quire resolves carries every K accumulations and when the quire is rounded.
+ Its results must be identical, bit for bit, to the reference quire for any K, and the
+ fused kernels must select it when HPRBLAS_CARRY_SAVE_QUIRE is set.
+ */
+
+template<size_t nbits, size_t es, size_t K>
+int VerifyDotProducts(const std::string& tag, std::mt19937_64& rng, size_t nrTests, size_t vecSize) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	constexpr uint64_t nar = uint64_t(1) << (nbits - 1);
+	int nrOfFailedTests = 0;
+	std::vector<Scalar> x(vecSize), y(vecSize);
+	double tref = 0.0, tlimb = 0.0, tcsa = 0.0;
+	for (size_t t = 0; t < nrTests; ++t) {
+		for (size_t i = 0; i < vecSize; ++i) {
+			uint64_t a = rng() >> (64 - nbits), b = rng() >> (64 - nbits);
+			x[i].setbits(a == nar ? 0 : a);
+			y[i].setbits(b == nar ? 0 : b);
+		}
+		// the second half cancels part of the first, forcing borrows through the deferred digits
+		for (size_t i = vecSize / 2; i < vecSize; i += 3) {
+			x[i] = -x[i - vecSize / 2];
+			y[i] = y[i - vecSize / 2];
+		}
+		auto t0 = std::chrono::steady_clock::now();
+		sw::universal::quire<nbits, es, 30> qref(0);
+		for (size_t i = 0; i < vecSize; ++i) qref += sw::universal::quire_mul(x[i], y[i]);
+		auto t1 = std::chrono::steady_clock::now();
+		sw::hprblas::limb_quire<nbits, es, 30> qlimb(0);
+		for (size_t i = 0; i < vecSize; ++i) qlimb.fma(x[i], y[i]);
+		auto t2 = std::chrono::steady_clock::now();
+		sw::hprblas::carry_save_quire<nbits, es, 30, K> qcsa(0);
+		for (size_t i = 0; i < vecSize; ++i) qcsa.fma(x[i], y[i]);
+		auto t3 = std::chrono::steady_clock::now();
+		tref += std::chrono::duration<double>(t1 - t0).count();
+		tlimb += std::chrono::duration<double>(t2 - t1).count();
+		tcsa += std::chrono::duration<double>(t3 - t2).count();
+
+		// merge two partial quires to exercise quire addition and subtraction
+		sw::hprblas::carry_save_quire<nbits, es, 30, K> lower(0), upper(0), negated(0);
+		for (size_t i = 0; i < vecSize / 2; ++i) lower.fma(x[i], y[i]);
+		for (size_t i = vecSize / 2; i < vecSize; ++i) upper.fma(x[i], y[i]);
+		for (size_t i = vecSize / 2; i < vecSize; ++i) negated.fma(-x[i], y[i]);
+		auto merged = lower;
+		merged += upper;
+		auto difference = lower;
+		difference -= negated;
+
+		Scalar pref, pcsa, pmerged, pdifference;
+		sw::universal::convert(qref.to_value(), pref);
+		sw::universal::convert(qcsa.to_value(), pcsa);
+		sw::universal::convert(merged.to_value(), pmerged);
+		sw::universal::convert(difference.to_value(), pdifference);
+		if (pref != pcsa || pref != pmerged || pref != pdifference) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: dot product " << t << " = " << pcsa << " (merged " << pmerged << ", difference " << pdifference << ") instead of " << pref << '\n';
+		}
+	}
+	std::cout << tag << " K = " << K << ": carry-save accumulation is " << (tcsa > 0.0 ? tref / tcsa : 0.0) << "x the speed of the reference quire and "
+	          << (tcsa > 0.0 ? tlimb / tcsa : 0.0) << "x the speed of the limb quire\n";
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es>
+int VerifyKernels(const std::string& tag, std::mt19937_64& rng, size_t N) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	static_assert(std::is_same_v<sw::hprblas::fused_quire_t<nbits, es>, sw::hprblas::carry_save_quire<nbits, es, 30> >, "fused kernels must select carry_save_quire");
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	mtl::mat::dense2D<Scalar> A(N, N);
+	mtl::vec::dense_vector<Scalar> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = dist(rng);
+		y[i] = dist(rng);
+		for (size_t j = 0; j < N; ++j) A[i][j] = dist(rng);
+	}
+	int nrOfFailedTests = 0;
+	{
+		sw::universal::quire<nbits, es, 10> q(0);
+		for (size_t i = 0; i < N; ++i) q += sw::universal::quire_mul(x[i], y[i]);
+		Scalar ref;
+		sw::universal::convert(q.to_value(), ref);
+		Scalar result = sw::hprblas::fdp(x, y);
+		Scalar strided = sw::hprblas::fdp_stride(N, x, 1, y, 1);
+		if (result != ref || strided != ref) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: fdp = " << result << " fdp_stride = " << strided << " instead of " << ref << '\n';
+		}
+	}
+	mtl::vec::dense_vector<Scalar> b = sw::hprblas::fmv(A, x);
+	for (size_t i = 0; i < N; ++i) {
+		sw::universal::quire<nbits, es> q(0);
+		for (size_t j = 0; j < N; ++j) q += sw::universal::quire_mul(A[i][j], x[j]);
+		Scalar ref;
+		sw::universal::convert(q.to_value(), ref);
+		if (ref != b[i]) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: fmv b[" << i << "] = " << b[i] << " instead of " << ref << '\n';
+		}
+	}
+	mtl::mat::dense2D<Scalar> C = sw::hprblas::fmm(A, A);
+	for (size_t i = 0; i < N; ++i) {
+		for (size_t j = 0; j < N; ++j) {
+			sw::universal::quire<nbits, es> q(0);
+			for (size_t k = 0; k < N; ++k) q += sw::universal::quire_mul(A[i][k], A[k][j]);
+			Scalar ref;
+			sw::universal::convert(q.to_value(), ref);
+			if (ref != C[i][j]) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: fmm C[" << i << "][" << j << "] = " << C[i][j] << " instead of " << ref << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(6);
+	{
+		int fails = VerifyDotProducts<16, 1, 1>("posit<16,1>", rng, 50, 1000);
+		fails += VerifyDotProducts<16, 1, 7>("posit<16,1>", rng, 50, 1000);
+		fails += VerifyDotProducts<16, 1, (size_t(1) << 30)>("posit<16,1>", rng, 100, 1000);
+		fails += VerifyKernels<16, 1>("posit<16,1>", rng, 29);
+		std::cout << "posit<16,1> carry_save_quire " << (fails ? "FAIL" : "PASS") << '\n';
+		nrOfFailedTestCases += fails;
+	}
+	{
+		int fails = VerifyDotProducts<32, 2, 1>("posit<32,2>", rng, 50, 1000);
+		fails += VerifyDotProducts<32, 2, 7>("posit<32,2>", rng, 50, 1000);
+		fails += VerifyDotProducts<32, 2, (size_t(1) << 30)>("posit<32,2>", rng, 100, 1000);
+		fails += VerifyKernels<32, 2>("posit<32,2>", rng, 29);
+		std::cout << "posit<32,2> carry_save_quire " << (fails ? "FAIL" : "PASS") << '\n';
+		nrOfFailedTestCases += fails;
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,182 @@
+// limb_quire.cpp: verify the 64-bit limb quire engine for posit<32,2> against the reference quire
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <random>
+#include <hprblas>
+
+/*
+ The fused kernels select limb_quire for posit<32,2>. Its results must be identical, bit for bit,
+ to the reference quire of the Universal library, including sums that cancel, sums that carry
+ and borrow across limbs, and quires that are merged with += and -=.
+ */
+
+using Scalar = sw::universal::posit<32, 2>;
+using Reference = sw::universal::quire<32, 2, 30>;
+using Native = sw::hprblas::limb_quire<32, 2, 30>;
+
+static Scalar posit_from_bits(uint64_t bits) {
+	Scalar p;
+	p.setbits(bits);
+	return p;
+}
+
+int VerifyProducts(std::mt19937_64& rng) {
+	std::vector<uint64_t> sample = { 0x00000001u, 0x00000002u, 0x00000003u, 0x7FFFFFFFu, 0x7FFFFFFEu, 0x40000000u, 0x40000001u,
+	                                 0xFFFFFFFFu, 0xFFFFFFFEu, 0x80000001u, 0xC0000000u, 0xBFFFFFFFu, 0x00000000u };
+	for (int i = 0; i < 200; ++i) sample.push_back(uint32_t(rng()));
+	int nrOfFailedTests = 0;
+	for (uint64_t a : sample) {
+		if (a == 0x80000000u) continue;
+		for (uint64_t b : sample) {
+			if (b == 0x80000000u) continue;
+			Scalar pa = posit_from_bits(a), pb = posit_from_bits(b), pref, pnative;
+			Reference qref(0);
+			qref += sw::universal::quire_mul(pa, pb);
+			Native qnative(0);
+			qnative.fma(pa, pb);
+			sw::universal::convert(qref.to_value(), pref);
+			sw::universal::convert(qnative.to_value(), pnative);
+			if (pref != pnative) {
+				if (++nrOfFailedTests < 10) std::cout << "FAIL: " << pa << " * " << pb << " = " << pnative << " instead of " << pref << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// dot products that cancel: every product is followed later by its negation, except for a small residue
+int VerifyCancellation(std::mt19937_64& rng, size_t nrTests, size_t vecSize) {
+	int nrOfFailedTests = 0;
+	for (size_t t = 0; t < nrTests; ++t) {
+		std::vector<Scalar> x, y;
+		for (size_t i = 0; i < vecSize; ++i) {
+			x.push_back(posit_from_bits(uint32_t(rng()) & 0x7FFFFFFFu));
+			y.push_back(posit_from_bits(uint32_t(rng()) & 0x7FFFFFFFu));
+		}
+		for (size_t i = 0; i < vecSize; ++i) {
+			x.push_back(-x[vecSize - 1 - i]);
+			y.push_back(y[vecSize - 1 - i]);
+		}
+		x.push_back(posit_from_bits(0x00000001u));   // minpos residue
+		y.push_back(posit_from_bits(0x40000000u));
+		Reference qref(0);
+		Native qnative(0);
+		for (size_t i = 0; i < x.size(); ++i) {
+			qref += sw::universal::quire_mul(x[i], y[i]);
+			qnative.fma(x[i], y[i]);
+		}
+		Scalar pref, pnative;
+		sw::universal::convert(qref.to_value(), pref);
+		sw::universal::convert(qnative.to_value(), pnative);
+		if (pref != pnative) {
+			if (++nrOfFailedTests < 10) std::cout << "FAIL: cancelling dot product " << t << " = " << pnative << " instead of " << pref << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+int VerifyDotProducts(std::mt19937_64& rng, size_t nrTests, size_t vecSize) {
+	int nrOfFailedTests = 0;
+	std::vector<Scalar> x(vecSize), y(vecSize);
+	double tref = 0.0, tnative = 0.0;
+	for (size_t t = 0; t < nrTests; ++t) {
+		for (size_t i = 0; i < vecSize; ++i) {
+			uint64_t a = uint32_t(rng()), b = uint32_t(rng());
+			x[i].setbits(a == 0x80000000u ? 0 : a);
+			y[i].setbits(b == 0x80000000u ? 0 : b);
+		}
+		auto t0 = std::chrono::steady_clock::now();
+		Reference qref(0);
+		for (size_t i = 0; i < vecSize; ++i) qref += sw::universal::quire_mul(x[i], y[i]);
+		auto t1 = std::chrono::steady_clock::now();
+		Native qnative(0);
+		for (size_t i = 0; i < vecSize; ++i) qnative.fma(x[i], y[i]);
+		auto t2 = std::chrono::steady_clock::now();
+		tref += std::chrono::duration<double>(t1 - t0).count();
+		tnative += std::chrono::duration<double>(t2 - t1).count();
+
+		// merge two halves to exercise quire addition and subtraction
+		Native lower(0), upper(0), negated(0);
+		for (size_t i = 0; i < vecSize / 2; ++i) lower.fma(x[i], y[i]);
+		for (size_t i = vecSize / 2; i < vecSize; ++i) upper.fma(x[i], y[i]);
+		for (size_t i = vecSize / 2; i < vecSize; ++i) negated.fma(-x[i], y[i]);
+		Native merged = lower;
+		merged += upper;
+		Native difference = lower;
+		difference -= negated;
+
+		Scalar pref, pnative, pmerged, pdifference;
+		sw::universal::convert(qref.to_value(), pref);
+		sw::universal::convert(qnative.to_value(), pnative);
+		sw::universal::convert(merged.to_value(), pmerged);
+		sw::universal::convert(difference.to_value(), pdifference);
+		if (pref != pnative || pref != pmerged || pref != pdifference) {
+			if (++nrOfFailedTests < 10) std::cout << "FAIL: dot product " << t << " = " << pnative << " (merged " << pmerged << ", difference " << pdifference << ") instead of " << pref << '\n';
+		}
+	}
+	std::cout << "posit<32,2> limb accumulation is " << (tnative > 0.0 ? tref / tnative : 0.0) << "x the speed of the reference quire\n";
+	return nrOfFailedTests;
+}
+
+// the fused kernels pick up limb_quire through fused_quire_t
+int VerifyKernels(std::mt19937_64& rng, size_t N) {
+	static_assert(std::is_same_v<sw::hprblas::fused_quire_t<32, 2>, Native>, "fused kernels must select limb_quire for posit<32,2>");
+	std::uniform_real_distribution<double> dist(-1.0e3, 1.0e3);
+	mtl::vec::dense_vector<Scalar> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = dist(rng);
+		y[i] = dist(rng);
+	}
+	sw::universal::quire<32, 2, 10> q(0);
+	for (size_t i = 0; i < N; ++i) q += sw::universal::quire_mul(x[i], y[i]);
+	Scalar ref;
+	sw::universal::convert(q.to_value(), ref);
+	Scalar result = sw::hprblas::fdp(x, y);
+	if (result != ref) {
+		std::cout << "FAIL: fdp = " << result << " instead of " << ref << '\n';
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(32);
+	int fails = VerifyProducts(rng);
+	fails += VerifyCancellation(rng, 100, 100);
+	fails += VerifyDotProducts(rng, 100, 1000);
+	fails += VerifyKernels(rng, 1000);
+	std::cout << "posit<32,2> limb_quire " << (fails ? "FAIL" : "PASS") << '\n';
+	nrOfFailedTestCases += fails;
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
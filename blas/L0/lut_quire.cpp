@@ -0,0 +1,125 @@
+// lut_quire.cpp: verify the table-driven quire engines against the reference quire
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <random>
+#include <hprblas>
+
+/*
+ The fused kernels select a table-driven accumulator for posit<8,0> and posit<16,1>.
+ Its results must be identical, bit for bit, to the reference quire of the Universal library.
+ */
+
+template<size_t nbits, size_t es, size_t capacity>
+int VerifyProducts(const std::string& tag, const std::vector<uint64_t>& as, const std::vector<uint64_t>& bs) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	constexpr uint64_t nar = uint64_t(1) << (nbits - 1);
+	int nrOfFailedTests = 0;
+	for (uint64_t a : as) {
+		if (a == nar) continue;
+		for (uint64_t b : bs) {
+			if (b == nar) continue;
+			Scalar pa, pb, pref, plut;
+			pa.setbits(a);
+			pb.setbits(b);
+			sw::universal::quire<nbits, es, capacity> qref(0);
+			qref += sw::universal::quire_mul(pa, pb);
+			sw::hprblas::lut_quire<nbits, es, capacity> qlut(0);
+			qlut.fma(pa, pb);
+			sw::universal::convert(qref.to_value(), pref);
+			sw::universal::convert(qlut.to_value(), plut);
+			if (pref != plut) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: " << pa << " * " << pb << " = " << plut << " instead of " << pref << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es, size_t capacity>
+int VerifyDotProducts(const std::string& tag, size_t nrTests, size_t vecSize) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	constexpr uint64_t nar = uint64_t(1) << (nbits - 1);
+	std::mt19937_64 rng(nbits);
+	int nrOfFailedTests = 0;
+	std::vector<Scalar> x(vecSize), y(vecSize);
+	double tref = 0.0, tlut = 0.0;
+	for (size_t t = 0; t < nrTests; ++t) {
+		for (size_t i = 0; i < vecSize; ++i) {
+			uint64_t a = rng() >> (64 - nbits), b = rng() >> (64 - nbits);
+			x[i].setbits(a == nar ? 0 : a);
+			y[i].setbits(b == nar ? 0 : b);
+		}
+		auto t0 = std::chrono::steady_clock::now();
+		sw::universal::quire<nbits, es, capacity> qref(0);
+		for (size_t i = 0; i < vecSize; ++i) qref += sw::universal::quire_mul(x[i], y[i]);
+		auto t1 = std::chrono::steady_clock::now();
+		sw::hprblas::lut_quire<nbits, es, capacity> qlut(0);
+		for (size_t i = 0; i < vecSize; ++i) qlut.fma(x[i], y[i]);
+		auto t2 = std::chrono::steady_clock::now();
+		tref += std::chrono::duration<double>(t1 - t0).count();
+		tlut += std::chrono::duration<double>(t2 - t1).count();
+		Scalar pref, plut;
+		sw::universal::convert(qref.to_value(), pref);
+		sw::universal::convert(qlut.to_value(), plut);
+		if (pref != plut) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: dot product " << t << " = " << plut << " instead of " << pref << '\n';
+		}
+	}
+	std::cout << tag << " table-driven accumulation is " << (tlut > 0.0 ? tref / tlut : 0.0) << "x the speed of the reference quire\n";
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	{
+		// exhaustive posit<8,0> products
+		std::vector<uint64_t> all(256);
+		for (uint64_t i = 0; i < 256; ++i) all[i] = i;
+		int fails = VerifyProducts<8, 0, 30>("posit<8,0>", all, all);
+		fails += VerifyDotProducts<8, 0, 30>("posit<8,0>", 100, 1000);
+		std::cout << "posit<8,0>  lut_quire " << (fails ? "FAIL" : "PASS") << '\n';
+		nrOfFailedTestCases += fails;
+	}
+	{
+		// all posit<16,1> encodings against a sample of multiplicands
+		std::vector<uint64_t> all(65536), sample;
+		for (uint64_t i = 0; i < 65536; ++i) all[i] = i;
+		for (uint64_t i = 0; i < 65536; i += 1021) sample.push_back(i);
+		sample.push_back(0x0001); sample.push_back(0x7FFF); sample.push_back(0x8001); sample.push_back(0xFFFF);
+		int fails = VerifyProducts<16, 1, 30>("posit<16,1>", all, sample);
+		fails += VerifyDotProducts<16, 1, 30>("posit<16,1>", 100, 1000);
+		std::cout << "posit<16,1> lut_quire " << (fails ? "FAIL" : "PASS") << '\n';
+		nrOfFailedTestCases += fails;
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,132 @@
+// posit_panel.cpp: verify the bulk posit decoder and the kernels that consume decoded panels
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <random>
+#include <hprblas>
+
+/*
+ decode_posit_bits processes bit patterns in SIMD lanes when the target supports AVX2 or AVX-512.
+ Every lane must agree with the scalar decoder, and the L2/L3 kernels that consume decoded panels
+ must be identical, bit for bit, to an accumulation in the reference quire.
+ */
+
+template<size_t nbits, size_t es>
+int VerifyDecoder(const std::string& tag, const std::vector<sw::hprblas::posit_bits_t<nbits> >& bits) {
+	size_t n = bits.size();
+	std::vector<uint32_t> significand(n);
+	std::vector<int32_t> scale(n);
+	std::vector<uint8_t> flags(n);
+	auto t0 = std::chrono::steady_clock::now();
+	sw::hprblas::decode_posit_bits<nbits, es>(n, bits.data(), significand.data(), scale.data(), flags.data());
+	auto t1 = std::chrono::steady_clock::now();
+	int nrOfFailedTests = 0;
+	for (size_t i = 0; i < n; ++i) {
+		sw::hprblas::decoded_posit d = sw::hprblas::decode_posit<nbits, es>(uint64_t(bits[i]));
+		uint8_t f = uint8_t((d.sign ? 1 : 0) | (d.nar ? 2 : 0));
+		bool same = (significand[i] == d.significand && flags[i] == f && (d.significand == 0 || scale[i] == d.scale));
+		if (!same) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: 0x" << std::hex << uint64_t(bits[i]) << std::dec
+				<< " decoded to (" << significand[i] << ", " << scale[i] << ", " << int(flags[i]) << ") instead of ("
+				<< d.significand << ", " << d.scale << ", " << int(f) << ")\n";
+		}
+	}
+	std::cout << tag << " decoded " << n << " posits in " << std::chrono::duration<double>(t1 - t0).count() << " sec\n";
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es>
+int VerifyKernels(const std::string& tag, size_t N) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	std::mt19937_64 rng(nbits);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	mtl::mat::dense2D<Scalar> A(N, N), B(N, N);
+	mtl::vec::dense_vector<Scalar> x(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = dist(rng);
+		for (size_t j = 0; j < N; ++j) {
+			A[i][j] = dist(rng);
+			B[i][j] = dist(rng);
+		}
+	}
+	int nrOfFailedTests = 0;
+
+	mtl::vec::dense_vector<Scalar> b(N);
+	sw::hprblas::matvec(b, A, x);
+	for (size_t i = 0; i < N; ++i) {
+		sw::universal::quire<nbits, es> q(0);
+		for (size_t j = 0; j < N; ++j) q += sw::universal::quire_mul(A[i][j], x[j]);
+		Scalar ref;
+		sw::universal::convert(q.to_value(), ref);
+		if (ref != b[i]) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: matvec b[" << i << "] = " << b[i] << " instead of " << ref << '\n';
+		}
+	}
+
+	mtl::mat::dense2D<Scalar> C = sw::hprblas::fmm(A, B);
+	for (size_t i = 0; i < N; ++i) {
+		for (size_t j = 0; j < N; ++j) {
+			sw::universal::quire<nbits, es> q(0);
+			for (size_t k = 0; k < N; ++k) q += sw::universal::quire_mul(A[i][k], B[k][j]);
+			Scalar ref;
+			sw::universal::convert(q.to_value(), ref);
+			if (ref != C[i][j]) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: fmm C[" << i << "][" << j << "] = " << C[i][j] << " instead of " << ref << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	{
+		// all posit<16,1> encodings, with a length that exercises the scalar tail
+		std::vector<uint16_t> all(65536 + 7);
+		for (size_t i = 0; i < all.size(); ++i) all[i] = uint16_t(i);
+		int fails = VerifyDecoder<16, 1>("posit<16,1>", all);
+		fails += VerifyKernels<16, 1>("posit<16,1>", 37);
+		std::cout << "posit<16,1> decoded panels " << (fails ? "FAIL" : "PASS") << '\n';
+		nrOfFailedTestCases += fails;
+	}
+	{
+		// random posit<32,2> encodings plus the special and extreme cases
+		std::mt19937_64 rng(32);
+		std::vector<uint32_t> sample = { 0x00000000u, 0x80000000u, 0x00000001u, 0x7FFFFFFFu, 0x80000001u, 0xFFFFFFFFu, 0x40000000u, 0xC0000000u };
+		for (size_t i = 0; i < 1000003; ++i) sample.push_back(uint32_t(rng()));
+		int fails = VerifyDecoder<32, 2>("posit<32,2>", sample);
+		fails += VerifyKernels<32, 2>("posit<32,2>", 23);
+		std::cout << "posit<32,2> decoded panels " << (fails ? "FAIL" : "PASS") << '\n';
+		nrOfFailedTestCases += fails;
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
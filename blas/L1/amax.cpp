@@ -0,0 +1,151 @@
+// amax.cpp: index of the element of largest and smallest magnitude
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <limits>
+#include <random>
+#include <hprblas>
+
+/*
+ amax and amin follow the i?amax semantics of the BLAS: they consider the n elements x[k*incx],
+ compare absolute values, and return the element number k of the first extreme element.
+ NaR and NaN count as the largest magnitude.
+ */
+
+// reference search on magnitudes converted to long double
+template<typename Vector, typename IsNaN>
+size_t reference_search(bool largest, size_t n, const Vector& x, size_t incx, IsNaN isnan) {
+	size_t index = 0;
+	bool found = false, foundNaN = false;
+	long double best = 0;
+	for (size_t k = 0; k < n; ++k) {
+		const auto& v = x[k * incx];
+		if (isnan(v)) {
+			if (largest && !foundNaN) { index = k; foundNaN = true; }
+			if (!largest && !found && !foundNaN) { index = k; foundNaN = true; }
+			continue;
+		}
+		if (largest && foundNaN) continue;
+		long double m = std::fabs((long double)v);
+		if (!found || (largest ? m > best : m < best)) { best = m; index = k; found = true; }
+	}
+	return index;
+}
+
+template<typename Vector, typename Generator, typename IsNaN>
+int VerifySearch(const std::string& tag, std::mt19937_64& rng, Generator next, IsNaN isnan) {
+	int nrOfFailedTests = 0;
+	for (size_t N : { size_t(1), size_t(31), size_t(1000), size_t(3001) }) {
+		for (int trial = 0; trial < 5; ++trial) {
+			Vector x(N);
+			for (size_t i = 0; i < N; ++i) x[i] = next(rng, N);
+			for (size_t incx : { size_t(1), size_t(3) }) {
+				for (size_t n : { N, N / 2 + 1, (N + incx - 1) / incx }) {
+					size_t m = std::min(n, (N + incx - 1) / incx);
+					size_t refMax = reference_search(true, m, x, incx, isnan);
+					size_t refMin = reference_search(false, m, x, incx, isnan);
+					size_t imax = sw::hprblas::amax(n, x, incx);
+					size_t imin = sw::hprblas::amin(n, x, incx);
+					if (imax != refMax || imin != refMin) {
+						if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: N " << N << " n " << n << " incx " << incx << " amax " << imax << " amin " << imin
+							<< " instead of " << refMax << " and " << refMin << '\n';
+					}
+				}
+			}
+		}
+	}
+	Vector empty(1);
+	if (sw::hprblas::amax(0, empty, 1) != 0 || sw::hprblas::amin(0, empty, 1) != 0) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: n = 0 does not return 0\n";
+	}
+	std::cout << tag << " amax and amin " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es>
+int VerifyPosit(const std::string& tag, std::mt19937_64& rng) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	constexpr uint64_t nar = uint64_t(1) << (nbits - 1);
+	// random encodings with few distinct values, so ties between positive and negative elements occur
+	auto next = [](std::mt19937_64& g, size_t N) {
+		Scalar p;
+		uint64_t bits = g() >> (64 - nbits);
+		if (N > 100 && g() % 4 != 0) bits = (bits >> (nbits - 6)) << (nbits - 6);
+		if (bits == nar && g() % 8 != 0) bits = 0;
+		p.setbits(bits);
+		return p;
+	};
+	auto isnar = [](const Scalar& p) { return p.isnar(); };
+	int nrOfFailedTests = VerifySearch< mtl::vec::dense_vector<Scalar> >(tag, rng, next, isnar);
+	nrOfFailedTests += VerifySearch< std::vector<Scalar> >(tag, rng, next, isnar);
+
+	// the posit infinity norm is the magnitude of the element found by amax
+	mtl::vec::dense_vector<Scalar> v(100);
+	for (size_t i = 0; i < 100; ++i) v[i] = double(i % 17) - 8.5;
+	v[40] = -12.25;
+	if (sw::hprblas::linf_norm(v) != Scalar(12.25)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: linf_norm = " << sw::hprblas::linf_norm(v) << " instead of 12.25\n";
+	}
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyIeee(const std::string& tag, std::mt19937_64& rng) {
+	auto next = [](std::mt19937_64& g, size_t N) {
+		std::uniform_real_distribution<double> dist(-1.0, 1.0);
+		switch (g() % 64) {
+		case 0: return std::numeric_limits<Real>::infinity();
+		case 1: return -std::numeric_limits<Real>::infinity();
+		case 2: return (N > 1000 ? std::numeric_limits<Real>::quiet_NaN() : Real(0));
+		case 3: return -Real(0);
+		case 4: return std::numeric_limits<Real>::denorm_min();
+		case 5: return Real(-0.5);
+		case 6: return Real(0.5);
+		default: return Real(dist(g) * 1.0e3);
+		}
+	};
+	auto isnan = [](Real v) { return std::isnan(v); };
+	return VerifySearch< std::vector<Real> >(tag, rng, next, isnan);
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(10);
+	nrOfFailedTestCases += VerifyPosit<8, 0>("posit<8,0> ", rng);
+	nrOfFailedTestCases += VerifyPosit<16, 1>("posit<16,1>", rng);
+	nrOfFailedTestCases += VerifyPosit<32, 2>("posit<32,2>", rng);
+	nrOfFailedTestCases += VerifyIeee<float>("float      ", rng);
+	nrOfFailedTestCases += VerifyIeee<double>("double     ", rng);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,179 @@
+// binned_reductions.cpp: reproducibility and accuracy of the binned accumulation mode
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <hprblas>
+
+/*
+ sum, asum, dot, and the norms accept an accumulation mode per call. The binned mode must produce
+ results that are bitwise identical for every permutation of the input and every thread count,
+ within n * 2^-64 of the largest magnitude of the exact result, and equal to the exact result when
+ all values fall inside the bins held.
+ */
+
+template<typename Scalar>
+long double magnitude_bound(const std::vector<Scalar>& x, const std::vector<Scalar>& y) {
+	long double m = 0;
+	for (size_t i = 0; i < x.size(); ++i) m = std::max(m, std::fabs((long double)x[i] * (long double)y[i]));
+	return m;
+}
+
+template<size_t nbits, size_t es>
+int VerifyPosit(const std::string& tag, std::mt19937_64& rng, size_t N) {
+	using namespace sw::hprblas;
+	using Scalar = sw::universal::posit<nbits, es>;
+	constexpr accumulation binned = accumulation::binned;
+	constexpr accumulation exact = accumulation::exact;
+	int nrOfFailedTests = 0;
+
+	// values over a wide dynamic range, and a set of large values that cancel exactly
+	std::uniform_real_distribution<double> dist(0.5, 1.0);
+	std::vector<Scalar> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = std::ldexp(dist(rng), int(rng() % 60) - 30) * ((rng() & 1) ? -1 : 1);
+		y[i] = std::ldexp(dist(rng), int(rng() % 20) - 10);
+	}
+	for (size_t i = 0; i < N / 8; ++i) {
+		x[i] = std::ldexp(dist(rng), 40);
+		x[N / 2 + i] = -x[i];
+	}
+	mtl::vec::dense_vector<Scalar> v(N);
+
+	Scalar s0 = sum<binned>(N, x, 1, 1), a0 = asum<binned>(N, x, 1, 1), d0 = dot<binned>(x, y);
+	Scalar se = sum<exact>(N, x, 1, 1), de = dot<exact>(x, y);
+	// the binned results are within n * 2^-64 of the largest magnitude of the exact result
+	long double bound = (long double)N * std::ldexp(1.0L, -64);
+	if (std::fabs((long double)s0 - (long double)se) > std::fabs((long double)se) * 1.0e-6L + bound * std::ldexp(1.0L, 41)
+		|| std::fabs((long double)d0 - (long double)de) > std::fabs((long double)de) * 1.0e-6L + bound * magnitude_bound(x, y)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: binned sum " << s0 << " dot " << d0 << " too far from " << se << " and " << de << '\n';
+	}
+	for (int permutation = 0; permutation < 3; ++permutation) {
+		for (size_t nrThreads = 1; nrThreads <= 8; nrThreads *= 2) {
+			Scalar s = sum<binned>(N, x, 1, nrThreads), a = asum<binned>(N, x, 1, nrThreads);
+			Scalar d;
+			auto q = reproducible_dot< binned_posit_accumulator<nbits, es> >(N, x, 1, y, 1, nrThreads);
+			sw::universal::convert(q.to_value(), d);
+			if (s != s0 || a != a0 || d != d0 || dot<binned>(x, y) != d0) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: permutation " << permutation << " threads " << nrThreads
+					<< " sum " << s << " asum " << a << " dot " << d << " instead of " << s0 << ' ' << a0 << ' ' << d0 << '\n';
+			}
+		}
+		std::vector<size_t> order(N);
+		for (size_t i = 0; i < N; ++i) order[i] = i;
+		std::shuffle(order.begin(), order.end(), rng);
+		std::vector<Scalar> xp(N), yp(N);
+		for (size_t i = 0; i < N; ++i) { xp[i] = x[order[i]]; yp[i] = y[order[i]]; }
+		x = xp; y = yp;
+	}
+
+	// values within 64 bits of the largest magnitude are summed exactly, and the norms agree with the quire
+	for (size_t i = 0; i < N; ++i) v[i] = std::ldexp(dist(rng), int(rng() % 16) - 8) * ((rng() & 1) ? -1 : 1);
+	if (sum<binned>(N, v) != sum<exact>(N, v) || asum<binned>(N, v) != asum(N, v)
+		|| l1_norm<binned>(v) != l1_norm(v) || l2_norm<binned>(v) != l2_norm(v)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: binned reductions of a narrow range are not exact\n";
+	}
+	if (sum<accumulation::standard>(N, v) != sum(N, v) || dot<accumulation::standard>(v, v) != dot(v, v)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: standard accumulation differs from the default\n";
+	}
+
+	// NaR propagates, and merging empty accumulators is neutral
+	binned_posit_accumulator<nbits, es> empty, one, nar;
+	one += Scalar(1);
+	one += empty;
+	empty += one;
+	nar += Scalar(sw::universal::SpecificValue::nar);
+	nar += one;
+	Scalar r1, rn;
+	sw::universal::convert(empty.to_value(), r1);
+	sw::universal::convert(nar.to_value(), rn);
+	if (r1 != Scalar(1) || !rn.isnar()) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: merge of empty accumulators or NaR propagation\n";
+	}
+	std::cout << tag << " binned reductions " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyIeee(const std::string& tag, std::mt19937_64& rng, size_t N) {
+	using namespace sw::hprblas;
+	constexpr accumulation binned = accumulation::binned;
+	int nrOfFailedTests = 0;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	std::vector<Real> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = Real(std::ldexp(dist(rng), int(rng() % 40) - 20));
+		y[i] = Real(dist(rng));
+	}
+	Real d0 = dot<binned>(x, y);
+	Real de = dot<accumulation::exact>(x, y);
+	if (std::fabs((long double)d0 - (long double)de) > std::fabs((long double)de) * 4 * std::numeric_limits<Real>::epsilon() + 1.0e-30L) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: binned dot " << d0 << " too far from " << de << '\n';
+	}
+	if (dot<accumulation::exact>(x, y) != dot(x, y) || sum<binned>(N, x) != sum(N, x) || sum<accumulation::exact>(N, x) != kulisch_dot(N, x, 1, std::vector<Real>(N, Real(1)), 1)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: accumulation modes do not select the expected accumulators\n";
+	}
+	for (int permutation = 0; permutation < 3; ++permutation) {
+		for (size_t nrThreads = 1; nrThreads <= 8; nrThreads *= 2) {
+			Real d = reproducible_dot< binned_accumulator<Real> >(N, x, 1, y, 1, nrThreads).value();
+			if (d != d0 || dot<binned>(N, x, 1, y, 1) != d0) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: permutation " << permutation << " threads " << nrThreads << " dot " << d << " instead of " << d0 << '\n';
+			}
+		}
+		std::vector<size_t> order(N);
+		for (size_t i = 0; i < N; ++i) order[i] = i;
+		std::shuffle(order.begin(), order.end(), rng);
+		std::vector<Real> xp(N), yp(N);
+		for (size_t i = 0; i < N; ++i) { xp[i] = x[order[i]]; yp[i] = y[order[i]]; }
+		x = xp; y = yp;
+	}
+	std::cout << tag << " binned reductions " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(12);
+	nrOfFailedTestCases += VerifyPosit<16, 1>("posit<16,1>", rng, 20000);
+	nrOfFailedTestCases += VerifyPosit<32, 2>("posit<32,2>", rng, 20000);
+	nrOfFailedTestCases += VerifyPosit<64, 3>("posit<64,3>", rng, 20000);
+	nrOfFailedTestCases += VerifyIeee<float>("float      ", rng, 20000);
+	nrOfFailedTestCases += VerifyIeee<double>("double     ", rng, 20000);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+// complex_fdp.cpp: fused dot products, matrix-vector and matrix-matrix products of complex posits
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <complex>
+#include <random>
+#include <hprblas>
+
+/*
+ The complex fused kernels accumulate the real and the imaginary part of each output element in
+ a complex_quire and round each component once. Every result must equal the rounding of the
+ exact sums accumulated independently in two reference quires.
+ */
+
+template<size_t nbits, size_t es>
+std::complex< sw::universal::posit<nbits, es> > reference_fdp(size_t n, const std::complex< sw::universal::posit<nbits, es> >* x, size_t incx,
+	                                                           const std::complex< sw::universal::posit<nbits, es> >* y, size_t incy, bool conjugate) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	sw::universal::quire<nbits, es> re(0), im(0);
+	for (size_t k = 0; k < n; ++k) {
+		Scalar xr = x[k * incx].real(), xi = x[k * incx].imag(), yr = y[k * incy].real(), yi = y[k * incy].imag();
+		if (conjugate) xi = -xi;
+		re += sw::universal::quire_mul(xr, yr);
+		re -= sw::universal::quire_mul(xi, yi);
+		im += sw::universal::quire_mul(xr, yi);
+		im += sw::universal::quire_mul(xi, yr);
+	}
+	Scalar r, i;
+	sw::universal::convert(re.to_value(), r);
+	sw::universal::convert(im.to_value(), i);
+	return std::complex<Scalar>(r, i);
+}
+
+template<size_t nbits, size_t es>
+int VerifyComplex(const std::string& tag, std::mt19937_64& rng) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Complex = std::complex<Scalar>;
+	using Vector = mtl::vec::dense_vector<Complex>;
+	int nrOfFailedTests = 0;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	auto random_complex = [&]() { return Complex(Scalar(std::ldexp(dist(rng), int(rng() % 16) - 8)), Scalar(std::ldexp(dist(rng), int(rng() % 16) - 8))); };
+
+	for (size_t N : { size_t(1), size_t(17), size_t(1000), size_t(10000) }) {
+		Vector x(N), y(N);
+		std::vector<Complex> xs(N), ys(N);
+		for (size_t i = 0; i < N; ++i) {
+			xs[i] = x[i] = random_complex();
+			ys[i] = y[i] = random_complex();
+		}
+		Complex ref = reference_fdp<nbits, es>(N, &xs[0], 1, &ys[0], 1, false);
+		Complex refc = reference_fdp<nbits, es>(N, &xs[0], 1, &ys[0], 1, true);
+		Complex refs = reference_fdp<nbits, es>((N + 2) / 3, &xs[0], 3, &ys[0], 3, false);
+		Complex f = sw::hprblas::fdp<Vector, 30>(x, y);
+		Complex fc = sw::hprblas::fdpc<Vector, 30>(x, y);
+		Complex fs = sw::hprblas::fdp_stride<Vector, 30>(N, x, 3, y, 3);
+		Complex fstl = sw::hprblas::fdp<std::vector<Complex>, 30>(xs, ys);
+		if (f != ref || fc != refc || fs != refs || fstl != ref) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: N " << N << " fdp " << f << " fdpc " << fc << " fdp_stride " << fs
+				<< " instead of " << ref << ' ' << refc << ' ' << refs << '\n';
+		}
+		for (size_t nrThreads = 1; nrThreads <= 8; nrThreads *= 2) {
+			Complex p = sw::hprblas::fdp_parallel<Vector, 30>(x, y, nrThreads);
+			if (p != ref) {
+				++nrOfFailedTests;
+				std::cout << tag << " FAIL: N " << N << " threads " << nrThreads << " fdp_parallel " << p << " instead of " << ref << '\n';
+			}
+		}
+	}
+
+	// fmv and fmm against the reference dot products of rows and columns
+	size_t nr = 7, nk = 33, nc = 5;
+	mtl::mat::dense2D<Complex> A(nr, nk), B(nk, nc);
+	Vector v(nk);
+	for (size_t i = 0; i < nr; ++i) for (size_t k = 0; k < nk; ++k) A[i][k] = random_complex();
+	for (size_t k = 0; k < nk; ++k) for (size_t j = 0; j < nc; ++j) B[k][j] = random_complex();
+	for (size_t k = 0; k < nk; ++k) v[k] = random_complex();
+	Vector b = sw::hprblas::fmv(A, v);
+	mtl::mat::dense2D<Complex> C = sw::hprblas::fmm(A, B);
+	std::vector<Complex> row(nk), column(nk), vs(nk);
+	for (size_t k = 0; k < nk; ++k) vs[k] = v[k];
+	for (size_t i = 0; i < nr; ++i) {
+		for (size_t k = 0; k < nk; ++k) row[k] = A[i][k];
+		if (b[i] != reference_fdp<nbits, es>(nk, &row[0], 1, &vs[0], 1, false)) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: fmv row " << i << '\n';
+		}
+		for (size_t j = 0; j < nc; ++j) {
+			for (size_t k = 0; k < nk; ++k) column[k] = B[k][j];
+			if (C[i][j] != reference_fdp<nbits, es>(nk, &row[0], 1, &column[0], 1, false)) {
+				++nrOfFailedTests;
+				std::cout << tag << " FAIL: fmm element " << i << ',' << j << '\n';
+			}
+		}
+	}
+	std::cout << tag << " complex fused kernels " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(15);
+	nrOfFailedTestCases += VerifyComplex<8, 0>("posit<8,0> ", rng);
+	nrOfFailedTestCases += VerifyComplex<16, 1>("posit<16,1>", rng);
+	nrOfFailedTestCases += VerifyComplex<32, 2>("posit<32,2>", rng);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,159 @@
+// contiguous_kernels.cpp: unit stride fast path of the Level-1 operators
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ axpy, copy, scale, swap, and rot dispatch unit stride calls on dense vectors to the contiguous
+ kernels. The results must be identical to element-by-element evaluation, including the tails
+ that do not fill a SIMD register, the bound n, and the posit multipliers 0, 1, and -1 that are
+ resolved on bit patterns. Operands are chosen such that all products are exact, so the
+ reference does not depend on the contraction of multiply-adds.
+ */
+
+template<typename Vector>
+bool same(const Vector& a, const Vector& b) {
+	using namespace mtl;
+	if (size(a) != size(b)) return false;
+	for (size_t i = 0; i < size(a); ++i) if (!(a[i] == b[i])) return false;
+	return true;
+}
+
+template<typename Vector>
+int VerifyOperators(const std::string& tag, std::mt19937_64& rng, size_t N, const typename Vector::value_type& a, const typename Vector::value_type& c, const typename Vector::value_type& s) {
+	using Scalar = typename Vector::value_type;
+	std::uniform_int_distribution<int> dist(-64, 64);
+	Vector x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = Scalar(dist(rng)) / Scalar(8);
+		y[i] = Scalar(dist(rng)) / Scalar(4);
+	}
+	int nrOfFailedTests = 0;
+	auto report = [&](const char* op, size_t n) {
+		if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: " << op << " n = " << n << " a = " << a << '\n';
+	};
+	for (size_t n : { size_t(0), size_t(1), size_t(7), N / 2 + 3, N, N + 5 }) {
+		size_t cnt = std::min(n, N);
+
+		Vector yr = y, yt = y;
+		for (size_t i = 0; i < cnt; ++i) yr[i] += a * x[i];
+		sw::hprblas::axpy(n, a, x, 1, yt, 1);
+		if (!same(yr, yt)) report("axpy", n);
+
+		yr = y; yt = y;
+		for (size_t i = 0; i < cnt; ++i) yr[i] = x[i];
+		sw::hprblas::copy(n, x, 1, yt, 1);
+		if (!same(yr, yt)) report("copy", n);
+
+		Vector xr = x, xt = x;
+		for (size_t i = 0; i < cnt; ++i) xr[i] *= a;
+		sw::hprblas::scale(n, a, xt, 1);
+		if (!same(xr, xt)) report("scale", n);
+
+		xr = x; xt = x; yr = y; yt = y;
+		for (size_t i = 0; i < cnt; ++i) std::swap(xr[i], yr[i]);
+		sw::hprblas::swap(n, xt, 1, yt, 1);
+		if (!same(xr, xt) || !same(yr, yt)) report("swap", n);
+
+		xr = x; xt = x; yr = y; yt = y;
+		for (size_t i = 0; i < cnt; ++i) {
+			Scalar x_i = c*xr[i] + s*yr[i];
+			Scalar y_i = c*yr[i] - s*xr[i];
+			yr[i] = y_i;
+			xr[i] = x_i;
+		}
+		sw::hprblas::rot(n, xt, 1, yt, 1, c, s);
+		if (!same(xr, xt) || !same(yr, yt)) report("rot", n);
+	}
+
+	// strided calls keep the generic path, and scale respects n
+	Vector xr = x, xt = x;
+	for (size_t i = 0, cnt = 0; cnt < 5 && i < N; ++cnt, i += 3) xr[i] *= a;
+	sw::hprblas::scale(5, a, xt, 3);
+	if (!same(xr, xt)) report("strided scale", 5);
+	return nrOfFailedTests;
+}
+
+template<typename Scalar>
+int VerifyType(const std::string& tag, std::mt19937_64& rng) {
+	int nrOfFailedTests = 0;
+	for (size_t N : { size_t(5), size_t(67), size_t(1000) }) {
+		for (double a : { 0.5, 3.0, 0.0, 1.0, -1.0 }) {
+			nrOfFailedTests += VerifyOperators< std::vector<Scalar> >(tag, rng, N, Scalar(a), Scalar(0.75), Scalar(-0.5));
+			nrOfFailedTests += VerifyOperators< mtl::vec::dense_vector<Scalar> >(tag, rng, N, Scalar(a), Scalar(0.75), Scalar(-0.5));
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// the posit multipliers 0, 1 and -1 must propagate NaR as a multiplication does
+template<size_t nbits, size_t es>
+int VerifyPositNaR(const std::string& tag) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	constexpr size_t N = 11;
+	int nrOfFailedTests = 0;
+	for (double a : { 0.0, 1.0, -1.0, 2.0 }) {
+		std::vector<Scalar> x(N), y(N);
+		for (size_t i = 0; i < N; ++i) {
+			x[i] = double(i) - 5.0;
+			y[i] = double(i) * 0.25;
+		}
+		x[3].setbits(uint64_t(1) << (nbits - 1));
+		y[7].setbits(uint64_t(1) << (nbits - 1));
+		std::vector<Scalar> yr = y, yt = y, xr = x, xt = x;
+		for (size_t i = 0; i < N; ++i) {
+			yr[i] += Scalar(a) * x[i];
+			xr[i] *= Scalar(a);
+		}
+		sw::hprblas::axpy(N, Scalar(a), x, 1, yt, 1);
+		sw::hprblas::scale(N, Scalar(a), xt, 1);
+		if (!same(yr, yt) || !same(xr, xt)) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: NaR propagation for a = " << a << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(8);
+	nrOfFailedTestCases += VerifyType<float>("float      ", rng);
+	nrOfFailedTestCases += VerifyType<double>("double     ", rng);
+	nrOfFailedTestCases += VerifyType< sw::universal::posit<16, 1> >("posit<16,1>", rng);
+	nrOfFailedTestCases += VerifyType< sw::universal::posit<32, 2> >("posit<32,2>", rng);
+	nrOfFailedTestCases += VerifyPositNaR<16, 1>("posit<16,1>");
+	nrOfFailedTestCases += VerifyPositNaR<32, 2>("posit<32,2>");
+	std::cout << "contiguous Level-1 kernels " << (nrOfFailedTestCases ? "FAIL" : "PASS") << '\n';
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
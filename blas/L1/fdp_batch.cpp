@@ -0,0 +1,78 @@
+// fdp_batch.cpp: verify the batched fused dot product against individual fdp calls
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <hprblas>
+
+/*
+ Workloads that issue thousands of short dot products, such as per-row residuals, are dominated
+ by the setup cost of the quire. The batched fused dot product sets up one quire per worker and
+ must produce the same rounded results as the individual fdp calls.
+ */
+
+template<size_t nbits, size_t es>
+int VerifyBatchedFdp(const std::string& tag, size_t nrPairs, size_t vecSize) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::dense_vector<Scalar>;
+	using Matrix = mtl::dense2D<Scalar>;
+	int nrOfFailedTests = 0;
+
+	std::vector<Vector> X(nrPairs), Y(nrPairs);
+	Matrix A(nrPairs, vecSize), B(nrPairs, vecSize);
+	for (size_t i = 0; i < nrPairs; ++i) {
+		X[i].change_dim(vecSize);
+		Y[i].change_dim(vecSize);
+		for (size_t j = 0; j < vecSize; ++j) {
+			X[i][j] = A[i][j] = Scalar(double(int(i * 7 + j * 3) % 23) - 11.0) / Scalar(double(j + 1));
+			Y[i][j] = B[i][j] = Scalar(double(int(i * 5 + j) % 17) - 8.0) * Scalar(0.125);
+		}
+	}
+
+	Vector batch(nrPairs), rows(nrPairs);
+	sw::hprblas::fdp_batch(batch, X, Y);
+	sw::hprblas::fdp_batch(rows, A, B);
+	for (size_t i = 0; i < nrPairs; ++i) {
+		Scalar reference = sw::hprblas::fdp(X[i], Y[i]);
+		if (batch[i] != reference || rows[i] != reference) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: pair " << i << " yields " << batch[i] << " and " << rows[i] << " instead of " << reference << '\n';
+		}
+	}
+	std::cout << tag << " batch of " << nrPairs << " dot products of length " << vecSize << (nrOfFailedTests ? " FAIL" : " PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += VerifyBatchedFdp<16, 1>("posit<16,1>", 1000, 8);
+	nrOfFailedTestCases += VerifyBatchedFdp<32, 2>("posit<32,2>", 500, 33);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
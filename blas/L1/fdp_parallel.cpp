@@ -0,0 +1,94 @@
+// fdp_parallel.cpp: verify that the parallel fused dot product is bitwise reproducible across thread counts
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <hprblas>
+
+/*
+ The parallel fused dot product splits the index range into blocks, accumulates each block
+ in its own quire, and merges the partial quires exactly before the single rounding step.
+ Its result must be identical, bit for bit, to the sequential fdp for any number of blocks.
+ */
+
+template<typename Vector>
+void FillCancellation(Vector& x, Vector& y) {
+	using Scalar = typename Vector::value_type;
+	size_t n = mtl::size(x);
+	Scalar big(sw::universal::SpecificValue::maxpos);
+	for (size_t i = 0; i < n; ++i) {
+		// alternating large and tiny terms that force catastrophic cancellation in non-fused arithmetic
+		x[i] = (i % 2 ? Scalar(1.0) / Scalar(double(i + 1)) : Scalar(double(i % 97) - 48.0));
+		y[i] = (i % 3 ? Scalar(double(i % 13) + 0.5) : Scalar(1.0) / Scalar(3.0));
+	}
+	x[0] = big * Scalar(0.0625);
+	y[0] = Scalar(1.0);
+	x[n - 1] = -x[0];
+	y[n - 1] = Scalar(1.0);
+}
+
+template<size_t nbits, size_t es>
+int VerifyParallelFdp(const std::string& tag, size_t vecSize) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::dense_vector<Scalar>;
+	int nrOfFailedTests = 0;
+	Vector x(vecSize), y(vecSize);
+	FillCancellation(x, y);
+
+	Scalar reference = sw::hprblas::fdp(x, y);
+	for (size_t nrThreads = 1; nrThreads <= 16; ++nrThreads) {
+		Scalar result = sw::hprblas::fdp_parallel(x, y, nrThreads);
+		if (result != reference) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: " << nrThreads << " threads yield " << result << " instead of " << reference << '\n';
+		}
+	}
+	// strided variant against the sequential strided fdp
+	for (size_t inc = 2; inc <= 3; ++inc) {
+		Scalar sref = sw::hprblas::fdp_stride(vecSize, x, inc, y, inc);
+		for (size_t nrThreads = 1; nrThreads <= 8; nrThreads *= 2) {
+			Scalar result = sw::hprblas::fdp_stride_parallel(vecSize, x, inc, y, inc, nrThreads);
+			if (result != sref) {
+				++nrOfFailedTests;
+				std::cout << tag << " FAIL: stride " << inc << " with " << nrThreads << " threads yields " << result << " instead of " << sref << '\n';
+			}
+		}
+	}
+	std::cout << tag << " fdp = " << reference << (nrOfFailedTests ? " FAIL" : " PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::cout << "Parallel fused dot product reproducibility using " << sw::hprblas::default_thread_pool().size() << " threads\n";
+	nrOfFailedTestCases += VerifyParallelFdp<16, 1>("posit<16,1>", 10000);
+	nrOfFailedTestCases += VerifyParallelFdp<32, 2>("posit<32,2>", 100000);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+// fused_updates.cpp: single rounding vector updates faxpy, faxpby and fwaxpby
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ Every element of a fused vector update must equal the exact value a*x + b*y rounded once,
+ as computed in the reference quire, for every stride and thread count.
+ */
+
+template<typename Scalar>
+Scalar reference_waxpby(const Scalar& a, const Scalar& x, const Scalar& b, const Scalar& y) {
+	constexpr size_t nbits = Scalar::nbits;
+	constexpr size_t es = Scalar::es;
+	sw::universal::quire<nbits, es> q(0);
+	q += sw::universal::quire_mul(a, x);
+	q += sw::universal::quire_mul(b, y);
+	Scalar result;
+	sw::universal::convert(q.to_value(), result);
+	return result;
+}
+
+template<size_t nbits, size_t es>
+int VerifyFusedUpdates(const std::string& tag, std::mt19937_64& rng, size_t N) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	Vector x(N), y(N), w(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = dist(rng);
+		y[i] = dist(rng) * 1000.0;
+	}
+	Scalar a(dist(rng)), b(dist(rng) * 3.0);
+
+	int nrOfFailedTests = 0;
+	auto report = [&](const char* op, size_t inc, size_t nrThreads, size_t i) {
+		if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: " << op << " inc " << inc << " threads " << nrThreads << " element " << i << '\n';
+	};
+	for (size_t inc : { size_t(1), size_t(2) }) {
+		size_t n = N / inc - 1;       // leaves the trailing elements untouched
+		for (size_t nrThreads : { size_t(1), size_t(4) }) {
+			Vector yt = y;
+			sw::hprblas::faxpy(n, a, x, inc, yt, inc, nrThreads);
+			for (size_t i = 0; i < N; ++i) {
+				bool updated = (i % inc == 0) && (i / inc < n);
+				Scalar ref = updated ? reference_waxpby(a, x[i], Scalar(1), y[i]) : y[i];
+				if (yt[i] != ref) report("faxpy", inc, nrThreads, i);
+			}
+
+			yt = y;
+			sw::hprblas::faxpby(n, a, x, inc, b, yt, inc, nrThreads);
+			for (size_t i = 0; i < N; ++i) {
+				bool updated = (i % inc == 0) && (i / inc < n);
+				Scalar ref = updated ? reference_waxpby(a, x[i], b, y[i]) : y[i];
+				if (yt[i] != ref) report("faxpby", inc, nrThreads, i);
+			}
+
+			Vector wt = w;
+			sw::hprblas::fwaxpby(n, a, x, inc, b, y, inc, wt, 1, nrThreads);
+			for (size_t i = 0; i < N; ++i) {
+				Scalar ref = (i < n) ? reference_waxpby(a, x[i * inc], b, y[i * inc]) : w[i];
+				if (wt[i] != ref) report("fwaxpby", inc, nrThreads, i);
+			}
+		}
+	}
+
+	// a single rounding is never less accurate than the rounded product followed by a rounded sum
+	size_t worse = 0;
+	Vector yf = y, yr = y;
+	sw::hprblas::faxpy(N, a, x, 1, yf, 1);
+	for (size_t i = 0; i < N; ++i) yr[i] += a * x[i];
+	for (size_t i = 0; i < N; ++i) {
+		long double exact = (long double)a * (long double)x[i] + (long double)y[i];
+		if (std::fabs((long double)yf[i] - exact) > std::fabs((long double)yr[i] - exact)) ++worse;
+	}
+	if (worse > 0) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: faxpy is less accurate than axpy for " << worse << " elements\n";
+	}
+	std::cout << tag << " fused vector updates " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(9);
+	nrOfFailedTestCases += VerifyFusedUpdates<8, 0>("posit<8,0> ", rng, 1001);
+	nrOfFailedTestCases += VerifyFusedUpdates<16, 1>("posit<16,1>", rng, 10001);
+	nrOfFailedTestCases += VerifyFusedUpdates<32, 2>("posit<32,2>", rng, 10001);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
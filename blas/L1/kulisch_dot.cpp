@@ -0,0 +1,185 @@
+// kulisch_dot.cpp: exact, reproducible dot products of IEEE floats and doubles
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <hprblas>
+
+/*
+ dot and fdp accumulate float and double products exactly in a kulisch_accumulator and round once.
+ A dot product a*b + c is therefore the fused multiply-add of the C library, for operands over the
+ whole exponent range, products that cancel leave the exact remainder, and the result does not
+ depend on the order of the elements or on the number of threads.
+ */
+
+// random value with an exponent drawn from [-range, range], including subnormals when range is large
+template<typename Real>
+Real random_value(std::mt19937_64& rng, int range) {
+	std::uniform_real_distribution<double> dist(0.5, 1.0);
+	int e = int(rng() % uint64_t(2 * range + 1)) - range;
+	Real v = Real(std::ldexp(dist(rng), e));
+	return (rng() & 1) ? -v : v;
+}
+
+template<typename Real>
+Real correctly_rounded_fma(Real a, Real b, Real c) {
+	if constexpr (std::is_same_v<Real, float>) return std::fmaf(a, b, c); else return std::fma(a, b, c);
+}
+
+template<typename Real>
+bool same(Real a, Real b) { return (std::isnan(a) && std::isnan(b)) || (a == b && std::signbit(a) == std::signbit(b)) || (a == 0 && b == 0); }
+
+template<typename Real>
+int VerifyRounding(const std::string& tag, std::mt19937_64& rng, int range, size_t nrTests) {
+	int nrOfFailedTests = 0;
+	std::vector<Real> x(19, Real(0)), y(19, Real(0));
+	for (size_t t = 0; t < nrTests; ++t) {
+		Real a = random_value<Real>(rng, range), b = random_value<Real>(rng, range), c = random_value<Real>(rng, range);
+		if (t % 3 == 0) c = -a * b * Real(1.0 + std::ldexp(1.0, -10));    // near cancellation
+		// the operands sit in a block of the vectorized fast path, and in the scalar tail
+		size_t i = t % x.size();
+		std::fill(x.begin(), x.end(), Real(0));
+		std::fill(y.begin(), y.end(), Real(0));
+		x[i] = a; y[i] = b;
+		x[(i + 5) % x.size()] = c; y[(i + 5) % x.size()] = Real(1);
+		Real ref = correctly_rounded_fma(a, b, c);
+		Real d = sw::hprblas::dot(x, y);
+		if (!std::isfinite(ref)) continue;      // the intermediate products of fma overflow differently
+		if (!same(d, ref)) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: " << a << " * " << b << " + " << c << " = " << d << " instead of " << ref << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyReproducibility(const std::string& tag, std::mt19937_64& rng, size_t N) {
+	int nrOfFailedTests = 0;
+	std::vector<Real> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = random_value<Real>(rng, 30);
+		y[i] = random_value<Real>(rng, 30);
+	}
+	// products of widely different magnitudes that cancel exactly in shuffled order, leaving the sum of the residues
+	constexpr int wide = (std::is_same_v<Real, double> ? 440 : 120);
+	std::vector<size_t> slot(2 * N + 5);
+	for (size_t i = 0; i < slot.size(); ++i) slot[i] = i;
+	std::shuffle(slot.begin(), slot.end(), rng);
+	std::vector<Real> u(slot.size()), v(slot.size());
+	for (size_t i = 0; i < N; ++i) {
+		Real a = random_value<Real>(rng, wide), b = random_value<Real>(rng, wide);
+		u[slot[2 * i]] = a; v[slot[2 * i]] = b;
+		u[slot[2 * i + 1]] = -a; v[slot[2 * i + 1]] = b;
+	}
+	for (int k = 1; k <= 5; ++k) { u[slot[2 * N + k - 1]] = Real(k); v[slot[2 * N + k - 1]] = Real(0.25); }
+	Real r0 = sw::hprblas::dot(u, v);
+	if (r0 != Real(3.75)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: cancelling dot product = " << r0 << " instead of 3.75\n";
+	}
+
+	Real d0 = sw::hprblas::dot(x, y);
+	long double approx = 0;
+	for (size_t i = 0; i < N; ++i) approx += (long double)x[i] * (long double)y[i];
+	if (std::fabs((long double)d0 - approx) > std::fabs(approx) * std::numeric_limits<Real>::epsilon() + 1e-30L) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: dot product = " << d0 << " too far from " << double(approx) << '\n';
+	}
+	for (int permutation = 0; permutation < 3; ++permutation) {
+		for (size_t nrThreads = 1; nrThreads <= 8; nrThreads *= 2) {
+			Real d = sw::hprblas::fdp_parallel(x, y, nrThreads);
+			if (!same(d, d0)) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: permutation " << permutation << " threads " << nrThreads << " = " << d << " instead of " << d0 << '\n';
+			}
+		}
+		if (!same(sw::hprblas::fdp(x, y), d0) || !same(sw::hprblas::dot(N, x, 1, y, 1), d0) || !same(sw::hprblas::fdp_stride(N, x, 1, y, 1), d0)) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: dot and fdp entry points disagree\n";
+		}
+		// permute x and y together
+		std::vector<size_t> order(N);
+		for (size_t i = 0; i < N; ++i) order[i] = i;
+		std::shuffle(order.begin(), order.end(), rng);
+		std::vector<Real> xp(N), yp(N);
+		for (size_t i = 0; i < N; ++i) { xp[i] = x[order[i]]; yp[i] = y[order[i]]; }
+		x = xp; y = yp;
+	}
+
+	// strided access walks the scalar path and must agree with a contiguous copy
+	std::vector<Real> xs, ys;
+	for (size_t i = 0; i < N; i += 3) xs.push_back(x[i]);
+	for (size_t i = 0; i < N; i += 2) ys.push_back(y[i]);
+	size_t m = std::min(xs.size(), ys.size());
+	xs.resize(m); ys.resize(m);
+	Real strided = sw::hprblas::dot(N, x, 3, y, 2);
+	if (!same(strided, sw::hprblas::dot(xs, ys))) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: strided dot product = " << strided << " instead of " << sw::hprblas::dot(xs, ys) << '\n';
+	}
+
+	// infinities and NaNs propagate
+	x[N / 2] = std::numeric_limits<Real>::infinity();
+	y[N / 2] = Real(1);
+	if (sw::hprblas::dot(x, y) != std::numeric_limits<Real>::infinity()) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: infinity does not propagate\n";
+	}
+	y[N / 2] = Real(0);
+	if (!std::isnan(sw::hprblas::dot(x, y))) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: inf * 0 does not yield NaN\n";
+	}
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyType(const std::string& tag, std::mt19937_64& rng) {
+	constexpr int maxExp = std::numeric_limits<Real>::max_exponent;
+	constexpr int minExp = std::numeric_limits<Real>::min_exponent - std::numeric_limits<Real>::digits;
+	int nrOfFailedTests = 0;
+	nrOfFailedTests += VerifyRounding<Real>(tag, rng, 40, 20000);
+	nrOfFailedTests += VerifyRounding<Real>(tag, rng, maxExp / 2, 20000);
+	nrOfFailedTests += VerifyRounding<Real>(tag, rng, -minExp - 1, 20000);   // subnormal and overflowing products
+	nrOfFailedTests += VerifyReproducibility<Real>(tag, rng, 20000);
+	std::cout << tag << " kulisch dot product " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(11);
+	nrOfFailedTestCases += VerifyType<float>("float ", rng);
+	nrOfFailedTestCases += VerifyType<double>("double", rng);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+// mixed_fdp.cpp: fused dot products of vectors with two different posit configurations
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ fdp<qnbits, qes>(x, y) accumulates the exact products of a posit<nbitsA, esA> vector x and a
+ posit<nbitsB, esB> vector y in a quire<qnbits, qes>. When x converts exactly into posit<qnbits, qes>
+ the result must be bitwise identical to the fdp of the converted vector, which is the computation
+ the mixed-configuration fdp replaces.
+ */
+
+template<size_t nbitsA, size_t esA, size_t nbitsB, size_t esB>
+int VerifyMixed(const std::string& tag, std::mt19937_64& rng, size_t N) {
+	using XScalar = sw::universal::posit<nbitsA, esA>;
+	using YScalar = sw::universal::posit<nbitsB, esB>;
+	constexpr size_t capacity = 30;
+	int nrOfFailedTests = 0;
+
+	// random encodings of x, except NaR, and values of y with a large dynamic range
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	mtl::vec::dense_vector<XScalar> x(N);
+	mtl::vec::dense_vector<YScalar> y(N), xc(N);
+	std::vector<YScalar> ys(N);
+	for (size_t i = 0; i < N; ++i) {
+		uint64_t bits = rng() >> (64 - nbitsA);
+		if (bits == (uint64_t(1) << (nbitsA - 1))) bits = 0;
+		x[i].setbits(bits);
+		y[i] = std::ldexp(dist(rng), int(rng() % 32) - 16);
+		ys[i] = y[i];
+		xc[i] = YScalar(double(x[i]));
+		if (double(xc[i]) != double(x[i])) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: test vector does not convert exactly\n";
+			return nrOfFailedTests;
+		}
+	}
+
+	YScalar reference = sw::hprblas::fdp<mtl::vec::dense_vector<YScalar>, capacity>(xc, y);
+	YScalar mixed = sw::hprblas::fdp<nbitsB, esB, capacity>(x, y);
+	YScalar reversed = sw::hprblas::fdp<nbitsB, esB, capacity>(y, x);
+	YScalar stl = sw::hprblas::fdp<nbitsB, esB, capacity>(x, ys);
+	if (mixed != reference || reversed != reference || stl != reference) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: fdp " << mixed << " reversed " << reversed << " std::vector " << stl << " instead of " << reference << '\n';
+	}
+	for (size_t incx : { size_t(2), size_t(3) }) {
+		YScalar sref = sw::hprblas::fdp_stride<mtl::vec::dense_vector<YScalar>, capacity>(N, xc, incx, y, 1);
+		YScalar s = sw::hprblas::fdp_stride<nbitsB, esB, capacity>(N, x, incx, y, 1);
+		if (s != sref) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: fdp_stride incx " << incx << " = " << s << " instead of " << sref << '\n';
+		}
+	}
+
+	// NaR in either operand yields NaR
+	x[N / 2].setbits(uint64_t(1) << (nbitsA - 1));
+	if (!sw::hprblas::fdp<nbitsB, esB, capacity>(x, y).isnar()) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: NaR does not propagate\n";
+	}
+	std::cout << tag << " mixed-configuration fdp " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(13);
+	nrOfFailedTestCases += VerifyMixed<8, 0, 16, 1>("posit<8,0>  x posit<16,1>", rng, 5000);
+	nrOfFailedTestCases += VerifyMixed<8, 0, 32, 2>("posit<8,0>  x posit<32,2>", rng, 5000);
+	nrOfFailedTestCases += VerifyMixed<16, 1, 32, 2>("posit<16,1> x posit<32,2>", rng, 5000);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,110 @@
+// quire_capacity.cpp: quire capacity derived from the number of products of a fused dot product
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ fdp_sized and fdp_auto select the quire capacity from the length of the dot product. The result
+ must equal the fdp in a quire of the default capacity, a dot product of 2^capacity - 1 products of
+ maxpos^2 must not overflow, and a length beyond the capacity must raise a quire_capacity_exception.
+ */
+
+template<size_t nbits, size_t es>
+int VerifyCapacity(const std::string& tag, std::mt19937_64& rng) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	int nrOfFailedTests = 0;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+	for (size_t N : { size_t(1), size_t(100), size_t(255), size_t(256), size_t(5000), size_t(70000) }) {
+		Vector x(N), y(N);
+		for (size_t i = 0; i < N; ++i) {
+			x[i] = dist(rng);
+			y[i] = dist(rng);
+		}
+		Scalar reference = sw::hprblas::fdp<Vector, 30>(x, y);
+		Scalar a = sw::hprblas::fdp_auto(x, y);
+		Scalar s = (N <= 255 ? sw::hprblas::fdp_sized<255>(x, y) : sw::hprblas::fdp_sized<70000>(x, y));
+		Scalar t = sw::hprblas::fdp_stride_auto(N, x, 3, y, 2, 4);
+		Scalar tref = sw::hprblas::fdp_stride<Vector, 30>(N, x, 3, y, 2);
+		if (a != reference || s != reference || t != tref) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: N " << N << " fdp_auto " << a << " fdp_sized " << s << " fdp_stride_auto " << t
+				<< " instead of " << reference << " and " << tref << '\n';
+		}
+	}
+
+	// the worst case: 2^8 - 1 products of maxpos^2 fit a capacity of 8 bits, and round to maxpos
+	Scalar maxpos;
+	maxpos.setbits((uint64_t(1) << (nbits - 1)) - 1);
+	Vector maxima(255);
+	for (size_t i = 0; i < 255; ++i) maxima[i] = maxpos;
+	if (sw::hprblas::fdp_sized<255>(maxima, maxima) != maxpos || sw::hprblas::fdp_auto(maxima, maxima) != maxpos) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: sum of 255 products of maxpos^2 does not round to maxpos\n";
+	}
+
+	// a length beyond the compile-time bound is reported
+	bool reported = false;
+	try {
+		sw::hprblas::fdp_sized<100>(maxima, maxima);
+	}
+	catch (const sw::hprblas::quire_capacity_exception& err) {
+		reported = (err.products() == 255 && err.capacity() == sw::hprblas::quire_capacity_for(100));
+	}
+	if (!reported) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: fdp_sized does not report a length beyond its capacity\n";
+	}
+	std::cout << tag << " capacity-aware fdp " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace sw::hprblas;
+	int nrOfFailedTestCases = 0;
+
+	static_assert(quire_capacity_for(0) == 0 && quire_capacity_for(1) == 1 && quire_capacity_for(255) == 8 && quire_capacity_for(256) == 9);
+	static_assert(quire_max_products(8) == 255 && quire_max_products(64) == ~size_t(0));
+	for (size_t capacity = 1; capacity < 40; ++capacity) {
+		if (quire_capacity_for(quire_max_products(capacity)) != capacity || quire_capacity_for(quire_max_products(capacity) + 1) != capacity + 1) {
+			++nrOfFailedTestCases;
+			std::cout << "FAIL: quire_capacity_for and quire_max_products disagree at capacity " << capacity << '\n';
+		}
+	}
+
+	std::mt19937_64 rng(14);
+	nrOfFailedTestCases += VerifyCapacity<8, 0>("posit<8,0> ", rng);
+	nrOfFailedTestCases += VerifyCapacity<16, 1>("posit<16,1>", rng);
+	nrOfFailedTestCases += VerifyCapacity<32, 2>("posit<32,2>", rng);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,218 @@
+// quire_serialization.cpp: serialized quires and exact reductions across processes
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/*
+ A serialized quire must load back into every quire engine of its configuration with the same
+ value, and serialized partial sums must merge to the quire of the whole dot product, when they
+ are merged in one process and when they are reduced over pipes between forked processes.
+ */
+
+template<typename Quire, typename Scalar>
+bool same_value(const Quire& a, const Scalar& b) {
+	Scalar v;
+	sw::universal::convert(a.to_value(), v);
+	return v == b;
+}
+
+template<size_t nbits, size_t es>
+int VerifyRoundTrip(const std::string& tag, std::mt19937_64& rng) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Quire = sw::hprblas::fused_quire_t<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es, 30>;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	int nrOfFailedTests = 0;
+
+	for (size_t N : { size_t(0), size_t(1), size_t(100), size_t(10000) }) {
+		Quire q;
+		Reference r(0);
+		for (size_t i = 0; i < N; ++i) {
+			Scalar a(std::ldexp(dist(rng), int(rng() % 20) - 10)), b(dist(rng));
+			sw::hprblas::quire_fma(q, a, b);
+			r += sw::universal::quire_mul(a, b);
+		}
+		// a quire of maxpos^2 products exercises the capacity bits
+		if (N == 10000) {
+			Scalar maxpos = std::numeric_limits<Scalar>::max();
+			for (int i = 0; i < 7; ++i) {
+				sw::hprblas::quire_fma(q, maxpos, maxpos);
+				r += sw::universal::quire_mul(maxpos, maxpos);
+			}
+		}
+		Scalar expected;
+		sw::universal::convert(r.to_value(), expected);
+		std::vector<uint8_t> bytes = sw::hprblas::serialize_quire(q);
+		std::vector<uint8_t> referenceBytes = sw::hprblas::serialize_quire(r);
+		Quire back = sw::hprblas::deserialize_quire<Quire>(bytes);
+		Reference referenceBack = sw::hprblas::deserialize_quire<Reference>(bytes);
+		if (bytes != referenceBytes || !same_value(back, expected) || !same_value(referenceBack, expected)
+			|| sw::hprblas::serialize_quire(referenceBack) != bytes) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: round trip of " << N << " products\n";
+		}
+		if (N == 0 && bytes.size() != 12) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: a zero quire serializes into " << bytes.size() << " bytes\n";
+		}
+	}
+
+	// negative values and NaR
+	Quire q;
+	sw::hprblas::quire_fma(q, Scalar(-3), Scalar(0.5));
+	if (!same_value(sw::hprblas::deserialize_quire<Quire>(sw::hprblas::serialize_quire(q)), Scalar(-1.5))) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: round trip of a negative quire\n";
+	}
+	Scalar nar;
+	nar.setnar();
+	sw::hprblas::quire_fma(q, nar, Scalar(1));
+	Scalar v;
+	sw::universal::convert(sw::hprblas::deserialize_quire<Quire>(sw::hprblas::serialize_quire(q)).to_value(), v);
+	if (!v.isnar()) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: NaR does not survive serialization\n";
+	}
+
+	// a serialized quire of another configuration is rejected
+	try {
+		sw::hprblas::deserialize_quire< sw::universal::quire<nbits, es, 20> >(sw::hprblas::serialize_quire(Quire()));
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: configuration mismatch is not detected\n";
+	}
+	catch (const sw::hprblas::quire_format_exception&) {}
+
+	std::cout << tag << " quire serialization " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es>
+int VerifyReductions(const std::string& tag, std::mt19937_64& rng, size_t nrRanks, size_t N) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Quire = sw::hprblas::fused_quire_t<nbits, es>;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	std::vector<Scalar> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = std::ldexp(dist(rng), int(rng() % 30) - 15);
+		y[i] = dist(rng);
+	}
+	Quire total;
+	for (size_t i = 0; i < N; ++i) sw::hprblas::quire_fma(total, x[i], y[i]);
+	Scalar expected;
+	sw::universal::convert(total.to_value(), expected);
+
+	// the partial sum of a rank is the quire of its slice of the dot product
+	auto partial = [&](size_t rank) {
+		size_t first, last;
+		sw::hprblas::block_range(N, nrRanks, rank, first, last);
+		Quire q;
+		for (size_t i = first; i < last; ++i) sw::hprblas::quire_fma(q, x[i], y[i]);
+		return q;
+	};
+
+	int nrOfFailedTests = 0;
+	std::vector< std::vector<uint8_t> > parts;
+	for (size_t rank = 0; rank < nrRanks; ++rank) parts.push_back(sw::hprblas::serialize_quire(partial(rank)));
+	Quire merged = sw::hprblas::deserialize_quire<Quire>(sw::hprblas::reduce_serialized<nbits, es, 30>(parts));
+	if (!same_value(merged, expected)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: reduce_serialized over " << nrRanks << " parts\n";
+	}
+
+#if defined(__unix__) || defined(__APPLE__)
+	// one pipe into every rank but the root, written by its children
+	std::vector<int> readEnd(nrRanks, -1), writeEnd(nrRanks, -1);
+	for (size_t rank = 1; rank < nrRanks; ++rank) {
+		int fds[2];
+		if (pipe(fds) != 0) throw std::runtime_error("pipe failed");
+		readEnd[rank] = fds[0];
+		writeEnd[rank] = fds[1];
+	}
+	// the pipe of rank r carries the message of r to its parent
+	auto receive = [&](size_t child) { return sw::hprblas::read_quire_message(readEnd[child]); };
+	std::vector<pid_t> children;
+	for (size_t rank = 1; rank < nrRanks; ++rank) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			int status = EXIT_SUCCESS;
+			try {
+				sw::hprblas::tree_reduce(rank, nrRanks, partial(rank), receive,
+					[&](size_t, const std::vector<uint8_t>& bytes) { sw::hprblas::write_quire_message(writeEnd[rank], bytes); });
+			}
+			catch (...) {
+				status = EXIT_FAILURE;
+			}
+			_exit(status);
+		}
+		children.push_back(pid);
+	}
+	Quire root = sw::hprblas::tree_reduce(0, nrRanks, partial(0), receive, [](size_t, const std::vector<uint8_t>&) {});
+	for (pid_t pid : children) {
+		int status = 0;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: rank process exited with status " << status << '\n';
+		}
+	}
+	for (size_t rank = 1; rank < nrRanks; ++rank) {
+		close(readEnd[rank]);
+		close(writeEnd[rank]);
+	}
+	if (!same_value(root, expected)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: tree_reduce over " << nrRanks << " processes\n";
+	}
+#endif
+	std::cout << tag << ' ' << nrRanks << " ranks exact reduction " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(20);
+	nrOfFailedTestCases += VerifyRoundTrip<8, 0>("posit<8,0> ", rng);
+	nrOfFailedTestCases += VerifyRoundTrip<16, 1>("posit<16,1>", rng);
+	nrOfFailedTestCases += VerifyRoundTrip<32, 2>("posit<32,2>", rng);
+	nrOfFailedTestCases += VerifyRoundTrip<12, 1>("posit<12,1>", rng);
+	for (size_t nrRanks : { size_t(1), size_t(2), size_t(5), size_t(8) }) {
+		nrOfFailedTestCases += VerifyReductions<16, 1>("posit<16,1>", rng, nrRanks, 10000);
+		nrOfFailedTestCases += VerifyReductions<32, 2>("posit<32,2>", rng, nrRanks, 10000);
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,164 @@
+// reproducible_sum.cpp: reproducibility of the parallel asum and sum reductions
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <hprblas>
+
+/*
+ asum and sum accumulate posits in a quire and floats and doubles in a binned accumulator.
+ The results must be bitwise identical for every thread count and every permutation of the
+ input, and the posit results must equal a sequential accumulation in the reference quire.
+ */
+
+template<typename Scalar>
+int VerifyPositReductions(const std::string& tag, size_t N) {
+	constexpr size_t nbits = Scalar::nbits;
+	constexpr size_t es = Scalar::es;
+	std::mt19937_64 rng(nbits);
+	std::uniform_real_distribution<double> dist(-1.0e3, 1.0e3);
+	mtl::vec::dense_vector<Scalar> x(N);
+	for (size_t i = 0; i < N; ++i) x[i] = dist(rng);
+
+	int nrOfFailedTests = 0;
+	for (size_t incx : { size_t(1), size_t(3) }) {
+		sw::universal::quire<nbits, es> qsum(0), qasum(0);
+		for (size_t i = 0; i < N; i += incx) {
+			qsum += x[i];
+			qasum += (x[i] < 0 ? -x[i] : x[i]);
+		}
+		Scalar refSum, refAsum;
+		sw::universal::convert(qsum.to_value(), refSum);
+		sw::universal::convert(qasum.to_value(), refAsum);
+		for (size_t nrThreads = 1; nrThreads <= 16; nrThreads *= 2) {
+			Scalar s = sw::hprblas::sum(N, x, incx, nrThreads);
+			Scalar a = sw::hprblas::asum(N, x, incx, nrThreads);
+			if (s != refSum || a != refAsum) {
+				++nrOfFailedTests;
+				std::cout << tag << " FAIL: incx " << incx << " threads " << nrThreads << " sum " << s << " asum " << a
+				          << " instead of " << refSum << " and " << refAsum << '\n';
+			}
+		}
+	}
+	std::cout << tag << " quire sum and asum " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyIeeeReductions(const std::string& tag, std::vector<Real> x) {
+	std::mt19937_64 rng(sizeof(Real));
+	size_t N = x.size();
+	Real s0 = sw::hprblas::sum(N, x, 1, 1);
+	Real a0 = sw::hprblas::asum(N, x, 1, 1);
+	int nrOfFailedTests = 0;
+	for (int permutation = 0; permutation < 4; ++permutation) {
+		for (size_t nrThreads = 1; nrThreads <= 16; nrThreads *= 2) {
+			Real s = sw::hprblas::sum(N, x, 1, nrThreads);
+			Real a = sw::hprblas::asum(N, x, 1, nrThreads);
+			bool same = (std::isnan(s0) ? std::isnan(s) : s == s0) && (std::isnan(a0) ? std::isnan(a) : a == a0);
+			if (!same) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: permutation " << permutation << " threads " << nrThreads
+					<< " sum " << s << " asum " << a << " instead of " << s0 << " and " << a0 << '\n';
+			}
+		}
+		std::shuffle(x.begin(), x.end(), rng);
+	}
+	std::cout << tag << " sum = " << s0 << " asum = " << a0 << (nrOfFailedTests ? " FAIL" : " PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyIeee(const std::string& tag, size_t N) {
+	std::mt19937_64 rng(sizeof(Real) + 1);
+	int nrOfFailedTests = 0;
+
+	// ill-conditioned: large values that cancel, with a small residue
+	std::vector<Real> x;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	for (size_t i = 0; i < N; ++i) {
+		Real v = Real(std::ldexp(dist(rng), int(rng() % 60) - 30));
+		x.push_back(v);
+		x.push_back(-v);
+	}
+	x.push_back(Real(1.0));
+	nrOfFailedTests += VerifyIeeeReductions(tag + " cancellation", x);
+	Real s = sw::hprblas::sum(x.size(), x);
+	if (s != Real(1.0)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: cancelling sum = " << s << " instead of 1\n";
+	}
+
+	// accuracy against a sum in long double on well-conditioned data
+	std::vector<Real> y(N);
+	long double exact = 0;
+	for (size_t i = 0; i < N; ++i) {
+		y[i] = Real(dist(rng) + 1.5);
+		exact += y[i];
+	}
+	nrOfFailedTests += VerifyIeeeReductions(tag + " positive", y);
+	Real t = sw::hprblas::sum(N, y);
+	if (std::fabs((long double)t - exact) > 2 * std::numeric_limits<Real>::epsilon() * std::fabs(exact)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: sum = " << t << " is too far from " << double(exact) << '\n';
+	}
+
+	// extremes of the exponent range
+	std::vector<Real> z = { std::numeric_limits<Real>::max(), -std::numeric_limits<Real>::max(), std::numeric_limits<Real>::max() / 3,
+	                        std::numeric_limits<Real>::denorm_min(), std::numeric_limits<Real>::min(), Real(-2.5) };
+	for (size_t i = 0; i < N / 10; ++i) z.push_back(Real(std::ldexp(dist(rng), int(rng() % 200) - 100)));
+	nrOfFailedTests += VerifyIeeeReductions(tag + " extremes", z);
+
+	// infinities and NaN propagate
+	std::vector<Real> w(N, Real(1));
+	w[N / 2] = std::numeric_limits<Real>::infinity();
+	nrOfFailedTests += VerifyIeeeReductions(tag + " infinity", w);
+	if (sw::hprblas::sum(N, w) != std::numeric_limits<Real>::infinity()) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: infinity does not propagate\n";
+	}
+	w[N / 3] = -std::numeric_limits<Real>::infinity();
+	if (!std::isnan(sw::hprblas::sum(N, w))) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: inf - inf does not yield NaN\n";
+	}
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += VerifyPositReductions< sw::universal::posit<16, 1> >("posit<16,1>", 50000);
+	nrOfFailedTestCases += VerifyPositReductions< sw::universal::posit<32, 2> >("posit<32,2>", 50000);
+	nrOfFailedTestCases += VerifyIeee<float>("float ", 20000);
+	nrOfFailedTestCases += VerifyIeee<double>("double", 20000);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
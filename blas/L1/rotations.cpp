@@ -0,0 +1,169 @@
+// rotations.cpp: Givens rotation generation and the fused rotation kernels
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <random>
+#include <hprblas>
+
+/*
+ rotg and rotmg must produce rotations that zero the second coordinate of the point they were
+ generated from. Every element of frot and frot_batch must equal the exact rotated value rounded
+ once, as computed in the reference quire, for every thread count.
+ */
+
+template<typename Scalar>
+void reference_rotate(const Scalar& c, const Scalar& s, Scalar& x, Scalar& y) {
+	constexpr size_t nbits = Scalar::nbits;
+	constexpr size_t es = Scalar::es;
+	sw::universal::quire<nbits, es> qx(0), qy(0);
+	qx += sw::universal::quire_mul(c, x);
+	qx += sw::universal::quire_mul(s, y);
+	qy += sw::universal::quire_mul(c, y);
+	qy -= sw::universal::quire_mul(s, x);
+	sw::universal::convert(qx.to_value(), x);
+	sw::universal::convert(qy.to_value(), y);
+}
+
+template<typename Real>
+int VerifyIeeeGenerators(const std::string& tag, std::mt19937_64& rng) {
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	Real eps = std::numeric_limits<Real>::epsilon();
+	int nrOfFailedTests = 0;
+	for (int i = 0; i < 1000; ++i) {
+		Real a = Real(std::ldexp(dist(rng), int(rng() % 40) - 20));
+		Real b = Real(std::ldexp(dist(rng), int(rng() % 40) - 20));
+		if (i == 0) b = Real(0);
+		if (i == 1) a = Real(0);
+		Real r = a, z = b, c, s;
+		sw::hprblas::rotg(r, z, c, s);
+		Real scale = std::fabs(a) + std::fabs(b);
+		if (std::fabs(c * c + s * s - 1) > 4 * eps || std::fabs(c * b - s * a) > 4 * eps * scale || std::fabs(c * a + s * b - r) > 4 * eps * scale) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: rotg(" << a << ", " << b << ") = " << c << ' ' << s << ' ' << r << '\n';
+		}
+
+		Real d1 = Real(std::fabs(dist(rng)) + 0.5), d2 = Real(std::fabs(dist(rng)) + 0.5), x1 = a, y1 = b;
+		Real param[5] = { 0, 0, 0, 0, 0 };
+		sw::hprblas::rotmg(d1, d2, x1, y1, param);
+		std::vector<Real> x = { a }, y = { b };
+		sw::hprblas::rotm(1, x, 1, y, 1, param);
+		if (std::fabs(y[0]) > 8 * eps * scale * (1 + std::fabs(param[1]) + std::fabs(param[2]) + std::fabs(param[3]) + std::fabs(param[4]))) {
+			if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: rotmg does not zero y: flag " << param[0] << " y " << y[0] << '\n';
+		}
+	}
+	std::cout << tag << " rotg and rotmg " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es>
+int VerifyFusedRotations(const std::string& tag, std::mt19937_64& rng, size_t N) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	int nrOfFailedTests = 0;
+
+	// rotg on posits zeroes b up to the precision of the rotation
+	Scalar a(dist(rng) * 8.0), b(dist(rng)), r = a, z = b, c, s;
+	sw::hprblas::rotg(r, z, c, s);
+	if (sw::universal::abs(c * b - s * a) > Scalar(8.0) * std::numeric_limits<Scalar>::epsilon()) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: rotg(" << a << ", " << b << ") = " << c << ' ' << s << '\n';
+	}
+
+	Vector x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = dist(rng) * 100.0;
+		y[i] = dist(rng);
+	}
+	for (size_t nrThreads : { size_t(1), size_t(4) }) {
+		Vector xt = x, yt = y;
+		sw::hprblas::frot(N, xt, 1, yt, 1, c, s, nrThreads);
+		for (size_t i = 0; i < N; ++i) {
+			Scalar xr = x[i], yr = y[i];
+			reference_rotate(c, s, xr, yr);
+			if (xt[i] != xr || yt[i] != yr) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: frot threads " << nrThreads << " element " << i << '\n';
+			}
+		}
+	}
+
+	// a sequence of rotations over the rows of a matrix, against the rotations applied row pair by row pair
+	size_t nr = 6, nc = N / 4;
+	mtl::mat::dense2D<Scalar> A(nr, nc), R(nr, nc);
+	std::vector<Scalar> cs(nr - 1), ss(nr - 1);
+	for (size_t i = 0; i < nr; ++i) for (size_t j = 0; j < nc; ++j) R[i][j] = A[i][j] = dist(rng);
+	for (size_t k = 0; k + 1 < nr; ++k) {
+		Scalar ak(dist(rng)), bk(dist(rng));
+		sw::hprblas::rotg(ak, bk, cs[k], ss[k]);
+		for (size_t j = 0; j < nc; ++j) reference_rotate(cs[k], ss[k], R[k][j], R[k + 1][j]);
+	}
+	for (size_t nrThreads : { size_t(1), size_t(4) }) {
+		mtl::mat::dense2D<Scalar> B(A);
+		sw::hprblas::frot_batch(B, cs, ss, nrThreads);
+		for (size_t i = 0; i < nr; ++i) {
+			for (size_t j = 0; j < nc; ++j) {
+				if (B[i][j] != R[i][j]) {
+					if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: frot_batch threads " << nrThreads << " element " << i << ',' << j << '\n';
+				}
+			}
+		}
+	}
+	// an empty sequence of rotations leaves the matrix untouched
+	mtl::mat::dense2D<Scalar> E(A);
+	sw::hprblas::frot_batch(E, std::vector<Scalar>(), std::vector<Scalar>(), 4);
+	sw::hprblas::frot_batch(E, cs, std::vector<Scalar>(), 4);
+	for (size_t i = 0; i < nr; ++i) {
+		for (size_t j = 0; j < nc; ++j) {
+			if (E[i][j] != A[i][j]) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: frot_batch without rotations changes element " << i << ',' << j << '\n';
+			}
+		}
+	}
+	std::cout << tag << " fused rotations " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(19);
+	nrOfFailedTestCases += VerifyIeeeGenerators<float>("float      ", rng);
+	nrOfFailedTestCases += VerifyIeeeGenerators<double>("double     ", rng);
+	nrOfFailedTestCases += VerifyFusedRotations<8, 0>("posit<8,0> ", rng, 1000);
+	nrOfFailedTestCases += VerifyFusedRotations<16, 1>("posit<16,1>", rng, 10000);
+	nrOfFailedTestCases += VerifyFusedRotations<32, 2>("posit<32,2>", rng, 10000);
+
+	std::complex<double> w(3.0, -4.0);
+	if (sw::hprblas::cabs(w) != 5.0) {
+		++nrOfFailedTestCases;
+		std::cout << "FAIL: cabs(" << w << ") = " << sw::hprblas::cabs(w) << '\n';
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
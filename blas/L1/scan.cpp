@@ -0,0 +1,145 @@
+// scan.cpp: correctly rounded and reproducible inclusive and exclusive prefix sums
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <random>
+#include <hprblas>
+
+/*
+ inclusive_scan and exclusive_scan carry exact accumulators across blocks. Every prefix must equal
+ the rounding of a sequential accumulation in the reference quire, or in long double arithmetic of
+ exactly representable data for IEEE elements, for every thread count and stride.
+ */
+
+template<typename Scalar>
+int VerifyPositScan(const std::string& tag, size_t N) {
+	constexpr size_t nbits = Scalar::nbits;
+	constexpr size_t es = Scalar::es;
+	std::mt19937_64 rng(nbits);
+	std::uniform_real_distribution<double> dist(-1.0e3, 1.0e3);
+	mtl::vec::dense_vector<Scalar> x(N);
+	for (size_t i = 0; i < N; ++i) x[i] = dist(rng);
+
+	int nrOfFailedTests = 0;
+	for (size_t incx : { size_t(1), size_t(3) }) {
+		size_t cnt = (N + incx - 1) / incx;
+		std::vector<Scalar> inclusive(cnt), exclusive(cnt);
+		sw::universal::quire<nbits, es> q(0);
+		for (size_t k = 0; k < cnt; ++k) {
+			sw::universal::convert(q.to_value(), exclusive[k]);
+			q += x[k * incx];
+			sw::universal::convert(q.to_value(), inclusive[k]);
+		}
+		for (size_t nrThreads = 1; nrThreads <= 16; nrThreads *= 2) {
+			mtl::vec::dense_vector<Scalar> yi(cnt), ye(cnt);
+			sw::hprblas::inclusive_scan(cnt, x, incx, yi, 1, nrThreads);
+			sw::hprblas::exclusive_scan(cnt, x, incx, ye, 1, nrThreads);
+			for (size_t k = 0; k < cnt; ++k) {
+				if (yi[k] != inclusive[k] || ye[k] != exclusive[k]) {
+					if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: incx " << incx << " threads " << nrThreads << " prefix " << k
+						<< " inclusive " << yi[k] << " exclusive " << ye[k] << " instead of " << inclusive[k] << " and " << exclusive[k] << '\n';
+				}
+			}
+		}
+	}
+
+	// in place
+	mtl::vec::dense_vector<Scalar> z(x);
+	sw::hprblas::inclusive_scan(N, z, 1, z, 1);
+	Scalar last = sw::hprblas::sum(N, x, 1);
+	if (z[N - 1] != last) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: in place scan ends in " << z[N - 1] << " instead of " << last << '\n';
+	}
+	std::cout << tag << " quire scan " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyIeeeScan(const std::string& tag, size_t N) {
+	std::mt19937_64 rng(sizeof(Real));
+	int nrOfFailedTests = 0;
+
+	// small integers: every prefix is exact, so any order of summation is correct
+	std::vector<Real> x(N);
+	for (size_t i = 0; i < N; ++i) x[i] = Real(int(rng() % 201) - 100);
+	std::vector<Real> y(N);
+	for (size_t nrThreads = 1; nrThreads <= 16; nrThreads *= 2) {
+		sw::hprblas::inclusive_scan(N, x, 1, y, 1, nrThreads);
+		long double exact = 0;
+		for (size_t k = 0; k < N; ++k) {
+			exact += x[k];
+			if (y[k] != Real(exact)) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: threads " << nrThreads << " prefix " << k << " = " << y[k] << " instead of " << double(exact) << '\n';
+			}
+		}
+	}
+
+	// cancellation: naive accumulation loses the small values, the exact carries do not
+	std::vector<Real> c = { Real(1), std::ldexp(Real(1), std::numeric_limits<Real>::digits + 4), Real(1), -std::ldexp(Real(1), std::numeric_limits<Real>::digits + 4) };
+	std::vector<Real> s(c.size());
+	sw::hprblas::inclusive_scan(c.size(), c, 1, s, 1);
+	if (s[3] != Real(2)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: cancelling scan ends in " << s[3] << " instead of 2\n";
+	}
+
+	// ill-conditioned data: the prefixes are identical for any thread count
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	for (size_t i = 0; i < N; ++i) x[i] = Real(std::ldexp(dist(rng), int(rng() % 80) - 40));
+	std::vector<Real> y0(N);
+	sw::hprblas::exclusive_scan(N, x, 1, y0, 1, 1);
+	if (y0[0] != Real(0)) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: exclusive scan starts with " << y0[0] << '\n';
+	}
+	for (size_t nrThreads = 2; nrThreads <= 16; nrThreads *= 2) {
+		sw::hprblas::exclusive_scan(N, x, 1, y, 1, nrThreads);
+		if (y != y0) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: exclusive scan depends on the thread count " << nrThreads << '\n';
+		}
+	}
+	std::cout << tag << " kulisch scan " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace sw::universal;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += VerifyPositScan< posit<8, 0> >("posit<8,0> ", 20000);
+	nrOfFailedTestCases += VerifyPositScan< posit<16, 1> >("posit<16,1>", 50000);
+	nrOfFailedTestCases += VerifyPositScan< posit<32, 2> >("posit<32,2>", 50000);
+	nrOfFailedTestCases += VerifyIeeeScan<float>("float      ", 50000);
+	nrOfFailedTestCases += VerifyIeeeScan<double>("double     ", 50000);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
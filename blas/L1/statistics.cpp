@@ -0,0 +1,151 @@
+// statistics.cpp: single-pass moments and norms of posit vectors
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <random>
+#include <hprblas>
+
+/*
+ statistics() reads the vector once. Its sum and norms must equal the results of the separate
+ reductions, its min and max those of a sequential search, its mean and variance must be close to
+ a two-pass evaluation in long double, and every result must be identical for any thread count.
+ */
+
+template<typename Scalar>
+bool same(const sw::hprblas::vector_statistics<Scalar>& a, const sw::hprblas::vector_statistics<Scalar>& b) {
+	return a.count == b.count && a.sum == b.sum && a.mean == b.mean && a.variance == b.variance && a.min == b.min && a.max == b.max
+		&& a.l1 == b.l1 && a.l2 == b.l2 && a.linf == b.linf;
+}
+
+template<typename Scalar>
+int VerifyStatistics(const std::string& tag, size_t N, double offset) {
+	std::mt19937_64 rng(Scalar::nbits);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	mtl::vec::dense_vector<Scalar> x(N);
+	for (size_t i = 0; i < N; ++i) x[i] = offset + dist(rng);
+
+	int nrOfFailedTests = 0;
+	auto s = sw::hprblas::statistics(x, 1);
+	for (size_t nrThreads = 2; nrThreads <= 16; nrThreads *= 2) {
+		if (!same(s, sw::hprblas::statistics(x, nrThreads))) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: statistics depend on the thread count " << nrThreads << '\n';
+		}
+	}
+
+	// sum and norms agree with the separate reductions
+	Scalar sum = sw::hprblas::sum(N, x, 1);
+	Scalar l1 = sw::hprblas::l1_norm(x);
+	Scalar l2 = sw::hprblas::l2_norm(x);
+	Scalar linf = sw::hprblas::linf_norm(x);
+	if (s.count != N || s.sum != sum || s.l1 != l1 || s.l2 != l2 || s.linf != linf) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: sum " << s.sum << " l1 " << s.l1 << " l2 " << s.l2 << " linf " << s.linf
+			<< " instead of " << sum << ' ' << l1 << ' ' << l2 << ' ' << linf << '\n';
+	}
+	Scalar mn = x[0], mx = x[0];
+	for (size_t i = 1; i < N; ++i) {
+		if (x[i] < mn) mn = x[i];
+		if (x[i] > mx) mx = x[i];
+	}
+	if (s.min != mn || s.max != mx) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: min " << s.min << " max " << s.max << " instead of " << mn << ' ' << mx << '\n';
+	}
+
+	// mean and variance against a two-pass evaluation
+	long double mean = 0, m2 = 0;
+	for (size_t i = 0; i < N; ++i) mean += (long double)x[i];
+	mean /= N;
+	for (size_t i = 0; i < N; ++i) m2 += ((long double)x[i] - mean) * ((long double)x[i] - mean);
+	long double variance = m2 / N;
+	long double eps = (long double)std::numeric_limits<Scalar>::epsilon();
+	if (std::fabs((long double)s.mean - mean) > eps * std::fabs(mean) || std::fabs((long double)s.variance - variance) > 4 * eps * variance) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: mean " << s.mean << " variance " << s.variance << " instead of " << double(mean) << ' ' << double(variance) << '\n';
+	}
+
+	// NaR propagates into every result
+	x[N / 2].setnar();
+	auto t = sw::hprblas::statistics(x);
+	if (!t.sum.isnar() || !t.variance.isnar() || !t.max.isnar() || !t.linf.isnar()) {
+		++nrOfFailedTests;
+		std::cout << tag << " FAIL: NaR does not propagate\n";
+	}
+	std::cout << tag << " offset " << offset << " mean " << s.mean << " variance " << s.variance << (nrOfFailedTests ? " FAIL" : " PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+// vectors of minpos magnitudes, whose sums are not representable and round away from their value
+template<typename Scalar>
+int VerifyMinposStatistics(const std::string& tag) {
+	Scalar minpos = std::numeric_limits<Scalar>::min();
+	int nrOfFailedTests = 0;
+	{
+		mtl::vec::dense_vector<Scalar> x(2);
+		x[0] = x[1] = minpos;
+		auto s = sw::hprblas::statistics(x);
+		// the mean of the exact sum 2 minpos is minpos, about which the second moment is 0
+		if (s.mean != minpos || !s.variance.iszero()) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: {minpos, minpos} mean " << s.mean << " variance " << s.variance << '\n';
+		}
+	}
+	{
+		mtl::vec::dense_vector<Scalar> x(3);
+		x[0] = minpos;
+		x[1] = -minpos;
+		x[2] = minpos;
+		auto s = sw::hprblas::statistics(x);
+		// posits do not round to zero: the mean minpos/3 rounds to minpos, the variance 4/3 minpos^2 to minpos
+		if (s.sum != minpos || s.mean != minpos || s.variance != minpos) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: {minpos, -minpos, minpos} sum " << s.sum << " mean " << s.mean << " variance " << s.variance << '\n';
+		}
+	}
+	std::cout << tag << " minpos statistics " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace sw::universal;
+	int nrOfFailedTestCases = 0;
+
+	// the offset makes the variance small against the square of the mean
+	nrOfFailedTestCases += VerifyStatistics< posit<16, 1> >("posit<16,1>", 20000, 0.0);
+	nrOfFailedTestCases += VerifyStatistics< posit<16, 1> >("posit<16,1>", 20000, 4.0);
+	nrOfFailedTestCases += VerifyStatistics< posit<16, 1> >("posit<16,1>", 20000, -12.0);
+	nrOfFailedTestCases += VerifyStatistics< posit<32, 2> >("posit<32,2>", 50000, 0.0);
+	nrOfFailedTestCases += VerifyStatistics< posit<32, 2> >("posit<32,2>", 50000, 100.0);
+	nrOfFailedTestCases += VerifyMinposStatistics< posit<16, 1> >("posit<16,1>");
+	nrOfFailedTestCases += VerifyMinposStatistics< posit<32, 2> >("posit<32,2>");
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,125 @@
+// strided_gather.cpp: fused dot products of strided operands through the packing layer
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <random>
+#include <hprblas>
+
+/*
+ Strided operands of dense vectors are gathered into contiguous blocks before they are accumulated.
+ The column dot products of a row-major matrix must equal the dot products of the same columns
+ copied into unit stride vectors, and, for posits, a sequential accumulation in the reference quire.
+ */
+
+template<typename Scalar>
+int VerifyPositColumns(const std::string& tag, size_t nr, size_t nc) {
+	constexpr size_t nbits = Scalar::nbits;
+	constexpr size_t es = Scalar::es;
+	std::mt19937_64 rng(nbits + nc);
+	std::uniform_real_distribution<double> dist(-4.0, 4.0);
+	// the row-major matrix is stored as a vector, so column j starts at index j with stride nc
+	mtl::vec::dense_vector<Scalar> A(nr * nc);
+	for (size_t i = 0; i < nr * nc; ++i) A[i] = dist(rng);
+
+	int nrOfFailedTests = 0;
+	for (size_t j = 0; j + 1 < nc; j += std::max<size_t>(1, nc / 4)) {
+		mtl::vec::dense_vector<Scalar> x(nr), y(nr);
+		sw::universal::quire<nbits, es> q(0);
+		for (size_t i = 0; i < nr; ++i) {
+			x[i] = A[i * nc + j];
+			y[i] = A[i * nc + j + 1];
+			q += sw::universal::quire_mul(x[i], y[i]);
+		}
+		Scalar ref;
+		sw::universal::convert(q.to_value(), ref);
+		Scalar unit = sw::hprblas::fdp(x, y);
+
+		// the columns j and j + 1, as two views into the same storage
+		mtl::vec::dense_vector<Scalar> cx(nr * nc - j), cy(nr * nc - j - 1);
+		for (size_t i = 0; i < size(cx); ++i) cx[i] = A[i + j];
+		for (size_t i = 0; i < size(cy); ++i) cy[i] = A[i + j + 1];
+		size_t n = (nr - 1) * nc + 1;
+		Scalar strided = sw::hprblas::fdp_stride(n, cx, nc, cy, nc);
+		Scalar parallel = sw::hprblas::fdp_stride_parallel(n, cx, nc, cy, nc, 4);
+		Scalar accumulated = sw::hprblas::dot<sw::hprblas::accumulation::exact>(nr, cx, nc, cy, nc);
+		if (unit != ref || strided != ref || parallel != ref || accumulated != ref) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: column " << j << " unit " << unit << " strided " << strided << " parallel " << parallel
+				<< " dot " << accumulated << " instead of " << ref << '\n';
+		}
+	}
+	std::cout << tag << ' ' << nr << 'x' << nc << " column fdp " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+template<typename Real>
+int VerifyIeeeColumns(const std::string& tag, size_t nr, size_t nc) {
+	std::mt19937_64 rng(sizeof(Real) + nc);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	std::vector<Real> A(nr * nc);
+	for (size_t i = 0; i < nr * nc; ++i) A[i] = Real(std::ldexp(dist(rng), int(rng() % 40) - 20));
+
+	int nrOfFailedTests = 0;
+	for (size_t j = 0; j + 1 < nc; j += std::max<size_t>(1, nc / 4)) {
+		std::vector<Real> x(nr), y(nr);
+		for (size_t i = 0; i < nr; ++i) {
+			x[i] = A[i * nc + j];
+			y[i] = A[i * nc + j + 1];
+		}
+		Real unit = sw::hprblas::dot(nr, x, 1, y, 1);
+		std::vector<Real> cx(A.begin() + j, A.end()), cy(A.begin() + j + 1, A.end());
+		Real strided = sw::hprblas::dot(nr, cx, nc, cy, nc);
+		Real binnedUnit = sw::hprblas::dot<sw::hprblas::accumulation::binned>(nr, x, 1, y, 1);
+		Real binnedStrided = sw::hprblas::dot<sw::hprblas::accumulation::binned>(nr, cx, nc, cy, nc);
+		if (strided != unit || binnedStrided != binnedUnit) {
+			++nrOfFailedTests;
+			std::cout << tag << " FAIL: column " << j << " strided " << strided << " binned " << binnedStrided
+				<< " instead of " << unit << " and " << binnedUnit << '\n';
+		}
+	}
+	std::cout << tag << ' ' << nr << 'x' << nc << " column dot " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace sw::universal;
+	int nrOfFailedTestCases = 0;
+
+	// row counts around multiples of the gather block
+	for (size_t nr : { size_t(1), size_t(255), size_t(257), size_t(1000) }) {
+		nrOfFailedTestCases += VerifyPositColumns< posit<8, 0> >("posit<8,0> ", nr, 9);
+		nrOfFailedTestCases += VerifyPositColumns< posit<16, 1> >("posit<16,1>", nr, 64);
+		nrOfFailedTestCases += VerifyPositColumns< posit<32, 2> >("posit<32,2>", nr, 33);
+		nrOfFailedTestCases += VerifyIeeeColumns<float>("float      ", nr, 64);
+		nrOfFailedTestCases += VerifyIeeeColumns<double>("double     ", nr, 33);
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+// parallel_matvec.cpp: row-partitioned fused matrix-vector products
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ The rows of a fused matrix-vector product are split over the thread pool in whole cache lines of
+ the output. Every element of b must equal the fused-dot product of its row, accumulated in the
+ reference quire and rounded once, for every thread count and for row counts that do not fill
+ the last cache line.
+ */
+
+template<size_t nbits, size_t es>
+int VerifyParallelMatvec(const std::string& tag, std::mt19937_64& rng, size_t nr, size_t nc) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	mtl::mat::dense2D<Scalar> A(nr, nc);
+	Vector x(nc);
+	for (size_t i = 0; i < nr; ++i) for (size_t j = 0; j < nc; ++j) A[i][j] = std::ldexp(dist(rng), int(rng() % 8) - 4);
+	for (size_t j = 0; j < nc; ++j) x[j] = dist(rng);
+
+	Vector ref(nr);
+	for (size_t i = 0; i < nr; ++i) {
+		sw::universal::quire<nbits, es> q(0);
+		for (size_t j = 0; j < nc; ++j) q += sw::universal::quire_mul(A[i][j], x[j]);
+		sw::universal::convert(q.to_value(), ref[i]);
+	}
+
+	int nrOfFailedTests = 0;
+	for (size_t nrThreads : { size_t(0), size_t(1), size_t(2), size_t(3), size_t(8), size_t(16) }) {
+		Vector b(nr);
+		sw::hprblas::matvec(b, A, x, nrThreads);
+		Vector c = sw::hprblas::fmv(A, x, nrThreads);
+		for (size_t i = 0; i < nr; ++i) {
+			if (b[i] != ref[i] || c[i] != ref[i]) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: threads " << nrThreads << " b[" << i << "] = " << b[i] << " fmv " << c[i] << " instead of " << ref[i] << '\n';
+			}
+		}
+	}
+	std::cout << tag << ' ' << nr << 'x' << nc << " parallel matvec " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(21);
+	for (size_t nr : { size_t(1), size_t(17), size_t(255), size_t(1000) }) {
+		nrOfFailedTestCases += VerifyParallelMatvec<8, 0>("posit<8,0> ", rng, nr, 64);
+		nrOfFailedTestCases += VerifyParallelMatvec<16, 1>("posit<16,1>", rng, nr, 100);
+		nrOfFailedTestCases += VerifyParallelMatvec<32, 2>("posit<32,2>", rng, nr, 257);
+		nrOfFailedTestCases += VerifyParallelMatvec<24, 1>("posit<24,1>", rng, nr, 33);
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+// sparse_matvec.cpp: fused sparse matrix-vector products of compressed row matrices
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <set>
+#include <hprblas>
+
+/*
+ The rows of a compressed2D are split over the thread pool in blocks of equal nonzero count.
+ Every element of b must equal the fused-dot product of the nonzeros of its row, accumulated in
+ the reference quire and rounded once, for every thread count, for empty rows, and for a few
+ dense rows that carry most of the nonzeros.
+ */
+
+template<size_t nbits, size_t es>
+int VerifySparseMatvec(const std::string& tag, std::mt19937_64& rng, size_t nr, size_t nc) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	using Matrix = mtl::mat::compressed2D<Scalar>;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+	// rows[i] holds the nonzeros (j, a_ij) of row i
+	std::vector< std::vector< std::pair<size_t, Scalar> > > rows(nr);
+	for (size_t i = 0; i < nr; ++i) {
+		size_t nnz = (i % 97 == 0 ? nc : size_t(rng() % 20));   // an occasional dense row
+		std::set<size_t> columns;
+		while (columns.size() < std::min(nnz, nc)) columns.insert(size_t(rng() % nc));
+		for (size_t j : columns) rows[i].emplace_back(j, Scalar(std::ldexp(dist(rng), int(rng() % 8) - 4)));
+	}
+	Matrix A(nr, nc);
+	{
+		mtl::mat::inserter<Matrix> ins(A, 20);
+		for (size_t i = 0; i < nr; ++i) for (const auto& e : rows[i]) ins[i][e.first] << e.second;
+	}
+	Vector x(nc);
+	for (size_t j = 0; j < nc; ++j) x[j] = dist(rng);
+
+	Vector ref(nr);
+	for (size_t i = 0; i < nr; ++i) {
+		sw::universal::quire<nbits, es> q(0);
+		for (const auto& e : rows[i]) q += sw::universal::quire_mul(e.second, x[e.first]);
+		sw::universal::convert(q.to_value(), ref[i]);
+	}
+
+	int nrOfFailedTests = 0;
+	for (size_t nrThreads : { size_t(0), size_t(1), size_t(3), size_t(8), size_t(32) }) {
+		Vector b(nr);
+		sw::hprblas::matvec(b, A, x, nrThreads);
+		Vector c = sw::hprblas::fmv(A, x, nrThreads);
+		for (size_t i = 0; i < nr; ++i) {
+			if (b[i] != ref[i] || c[i] != ref[i]) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: threads " << nrThreads << " b[" << i << "] = " << b[i] << " fmv " << c[i] << " instead of " << ref[i] << '\n';
+			}
+		}
+	}
+	std::cout << tag << ' ' << nr << 'x' << nc << " sparse matvec " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(23);
+	for (size_t nr : { size_t(1), size_t(100), size_t(5000) }) {
+		nrOfFailedTestCases += VerifySparseMatvec<8, 0>("posit<8,0> ", rng, nr, 300);
+		nrOfFailedTestCases += VerifySparseMatvec<16, 1>("posit<16,1>", rng, nr, 1000);
+		nrOfFailedTestCases += VerifySparseMatvec<32, 2>("posit<32,2>", rng, nr, 2000);
+		nrOfFailedTestCases += VerifySparseMatvec<24, 1>("posit<24,1>", rng, nr, 500);
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,102 @@
+// symmetric_matvec.cpp: fused symmetric matrix-vector products that read one triangle
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ fsymv and fspmv read only the stored triangle of a symmetric matrix. Every element of b must equal
+ the fused-dot product of the full row of A with x, accumulated in the reference quire and rounded
+ once, for both triangles, for the dense and the packed layout, and for every thread count.
+ The triangle that is not stored is filled with NaR, so reading it would poison the result.
+ */
+
+template<size_t nbits, size_t es>
+int VerifySymmetricMatvec(const std::string& tag, std::mt19937_64& rng, size_t n) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	using sw::hprblas::triangle;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	mtl::mat::dense2D<Scalar> A(n, n);
+	Vector x(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = dist(rng);
+		for (size_t j = i; j < n; ++j) A[i][j] = A[j][i] = std::ldexp(dist(rng), int(rng() % 8) - 4);
+	}
+
+	Vector ref(n);
+	for (size_t i = 0; i < n; ++i) {
+		sw::universal::quire<nbits, es> q(0);
+		for (size_t j = 0; j < n; ++j) q += sw::universal::quire_mul(A[i][j], x[j]);
+		sw::universal::convert(q.to_value(), ref[i]);
+	}
+
+	int nrOfFailedTests = 0;
+	Scalar nar;
+	nar.setnar();
+	for (triangle uplo : { triangle::upper, triangle::lower }) {
+		mtl::mat::dense2D<Scalar> S(A);
+		Vector AP(sw::hprblas::packed_size(n));
+		for (size_t j = 0; j < n; ++j) {
+			for (size_t i = 0; i < n; ++i) {
+				bool stored = (uplo == triangle::upper ? i <= j : i >= j);
+				if (!stored) S[i][j] = nar;
+				else if (uplo == triangle::upper) AP[i + j * (j + 1) / 2] = A[i][j];
+				else AP[i + j * (2 * n - j - 1) / 2] = A[i][j];
+			}
+		}
+		for (size_t nrThreads : { size_t(0), size_t(1), size_t(2), size_t(3), size_t(8) }) {
+			Vector b = sw::hprblas::fsymv(uplo, S, x, nrThreads);
+			Vector c = sw::hprblas::fspmv(uplo, AP, x, nrThreads);
+			for (size_t i = 0; i < n; ++i) {
+				if (b[i] != ref[i] || c[i] != ref[i]) {
+					if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: " << (uplo == triangle::upper ? "upper" : "lower") << " threads " << nrThreads
+						<< " b[" << i << "] = " << b[i] << " packed " << c[i] << " instead of " << ref[i] << '\n';
+				}
+			}
+		}
+	}
+	std::cout << tag << ' ' << n << 'x' << n << " symmetric matvec " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(24);
+	for (size_t n : { size_t(1), size_t(2), size_t(31), size_t(500) }) {
+		nrOfFailedTestCases += VerifySymmetricMatvec<8, 0>("posit<8,0> ", rng, n);
+		nrOfFailedTestCases += VerifySymmetricMatvec<16, 1>("posit<16,1>", rng, n);
+		nrOfFailedTestCases += VerifySymmetricMatvec<32, 2>("posit<32,2>", rng, n);
+		nrOfFailedTestCases += VerifySymmetricMatvec<24, 1>("posit<24,1>", rng, n);
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+// transposed_matvec.cpp: fused transposed matrix-vector products with a tile of column quires
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ fmv_trans streams the rows of A through a tile of column quires. Every element of b = A^T * x must
+ equal the fused-dot product of its column of A with x, accumulated in the reference quire and
+ rounded once, for every thread count and for column counts that do not fill the last tile.
+ */
+
+template<size_t nbits, size_t es>
+int VerifyTransposedMatvec(const std::string& tag, std::mt19937_64& rng, size_t nr, size_t nc) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	mtl::mat::dense2D<Scalar> A(nr, nc);
+	Vector x(nr);
+	for (size_t i = 0; i < nr; ++i) for (size_t j = 0; j < nc; ++j) A[i][j] = std::ldexp(dist(rng), int(rng() % 8) - 4);
+	for (size_t i = 0; i < nr; ++i) x[i] = dist(rng);
+
+	Vector ref(nc);
+	for (size_t j = 0; j < nc; ++j) {
+		sw::universal::quire<nbits, es> q(0);
+		for (size_t i = 0; i < nr; ++i) q += sw::universal::quire_mul(A[i][j], x[i]);
+		sw::universal::convert(q.to_value(), ref[j]);
+	}
+
+	int nrOfFailedTests = 0;
+	for (size_t nrThreads : { size_t(0), size_t(1), size_t(3), size_t(8) }) {
+		Vector b(nc);
+		sw::hprblas::matvec_trans(b, A, x, nrThreads);
+		Vector c = sw::hprblas::fmv_trans(A, x, nrThreads);
+		for (size_t j = 0; j < nc; ++j) {
+			if (b[j] != ref[j] || c[j] != ref[j]) {
+				if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: threads " << nrThreads << " b[" << j << "] = " << b[j] << " fmv_trans " << c[j] << " instead of " << ref[j] << '\n';
+			}
+		}
+	}
+	std::cout << tag << ' ' << nr << 'x' << nc << " transposed matvec " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(22);
+	// column counts around multiples of the column quire tile
+	for (size_t nc : { size_t(1), size_t(255), size_t(256), size_t(1000) }) {
+		nrOfFailedTestCases += VerifyTransposedMatvec<8, 0>("posit<8,0> ", rng, 64, nc);
+		nrOfFailedTestCases += VerifyTransposedMatvec<16, 1>("posit<16,1>", rng, 100, nc);
+		nrOfFailedTestCases += VerifyTransposedMatvec<32, 2>("posit<32,2>", rng, 77, nc);
+		nrOfFailedTestCases += VerifyTransposedMatvec<24, 1>("posit<24,1>", rng, 33, nc);
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+// rank_updates.cpp: fused rank-1 and rank-k updates of posit matrices
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPR-BLAS project, which is released under an MIT Open Source license.
+#include <random>
+#include <hprblas>
+
+/*
+ fger, fsyr, and fsyrk update a matrix in place with one rounding per element. Every updated
+ element must equal beta * c_ij plus the products with alpha * x, or alpha * A, rounded per element
+ as the reference BLAS forms them, accumulated in the reference quire and rounded once. The triangle
+ that fsyr and fsyrk do not own is filled with NaR and must come back untouched, and fsyrk with
+ beta = 0 must not read C. Results must not depend on the thread count.
+ */
+
+template<typename Scalar>
+Scalar reference_update(const Scalar& c, const Scalar& beta, const std::vector< std::pair<Scalar, Scalar> >& products) {
+	constexpr size_t nbits = Scalar::nbits;
+	constexpr size_t es = Scalar::es;
+	sw::universal::quire<nbits, es> q(0);
+	if (!beta.iszero()) q += sw::universal::quire_mul(beta, c);
+	for (const auto& p : products) q += sw::universal::quire_mul(p.first, p.second);
+	Scalar r;
+	sw::universal::convert(q.to_value(), r);
+	return r;
+}
+
+template<size_t nbits, size_t es>
+int VerifyRankUpdates(const std::string& tag, std::mt19937_64& rng, size_t n, size_t k) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Vector = mtl::vec::dense_vector<Scalar>;
+	using Matrix = mtl::mat::dense2D<Scalar>;
+	using sw::hprblas::triangle;
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	Scalar nar;
+	nar.setnar();
+	int nrOfFailedTests = 0;
+
+	size_t m = n + 3;
+	Matrix A(m, n), S(n, n), B(n, k);
+	Vector x(m), y(n), z(n);
+	for (size_t i = 0; i < m; ++i) for (size_t j = 0; j < n; ++j) A[i][j] = dist(rng);
+	for (size_t i = 0; i < n; ++i) for (size_t j = 0; j < n; ++j) S[i][j] = dist(rng);
+	for (size_t i = 0; i < n; ++i) for (size_t j = 0; j < k; ++j) B[i][j] = std::ldexp(dist(rng), int(rng() % 8) - 4);
+	for (size_t i = 0; i < m; ++i) x[i] = dist(rng);
+	for (size_t j = 0; j < n; ++j) y[j] = dist(rng);
+	for (size_t j = 0; j < n; ++j) z[j] = dist(rng);
+
+	for (Scalar alpha : { Scalar(-1), Scalar(0.375) }) {
+		for (size_t nrThreads : { size_t(0), size_t(1), size_t(3), size_t(8) }) {
+			// A = A + alpha * x * y^T
+			Matrix G(A);
+			sw::hprblas::fger(alpha, x, y, G, nrThreads);
+			for (size_t i = 0; i < m; ++i) {
+				for (size_t j = 0; j < n; ++j) {
+					Scalar ref = reference_update(A[i][j], Scalar(1), { { alpha * x[i], y[j] } });
+					if (G[i][j] != ref) {
+						if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: fger threads " << nrThreads << " element " << i << ',' << j << ' ' << G[i][j] << " instead of " << ref << '\n';
+					}
+				}
+			}
+
+			for (triangle uplo : { triangle::upper, triangle::lower }) {
+				auto owned = [uplo](size_t i, size_t j) { return (uplo == triangle::upper ? i <= j : i >= j); };
+
+				// A = A + alpha * z * z^T on the uplo triangle
+				Matrix T(S);
+				for (size_t i = 0; i < n; ++i) for (size_t j = 0; j < n; ++j) if (!owned(i, j)) T[i][j] = nar;
+				sw::hprblas::fsyr(uplo, alpha, z, T, nrThreads);
+				for (size_t i = 0; i < n; ++i) {
+					for (size_t j = 0; j < n; ++j) {
+						Scalar ref = (owned(i, j) ? reference_update(S[i][j], Scalar(1), { { alpha * z[i], z[j] } }) : nar);
+						if (T[i][j] != ref) {
+							if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: fsyr threads " << nrThreads << " element " << i << ',' << j << ' ' << T[i][j] << " instead of " << ref << '\n';
+						}
+					}
+				}
+
+				// C = alpha * B * B^T + beta * C on the uplo triangle, with beta = 0 on a C of NaR
+				for (Scalar beta : { Scalar(0), Scalar(0.5) }) {
+					Matrix C(S);
+					for (size_t i = 0; i < n; ++i) for (size_t j = 0; j < n; ++j) if (!owned(i, j) || beta.iszero()) C[i][j] = nar;
+					sw::hprblas::fsyrk(uplo, alpha, B, beta, C, nrThreads);
+					for (size_t i = 0; i < n; ++i) {
+						for (size_t j = 0; j < n; ++j) {
+							Scalar ref = nar;
+							if (owned(i, j)) {
+								std::vector< std::pair<Scalar, Scalar> > products;
+								for (size_t l = 0; l < k; ++l) products.emplace_back(B[i][l], alpha * B[j][l]);
+								ref = reference_update(S[i][j], beta, products);
+							}
+							if (C[i][j] != ref) {
+								if (++nrOfFailedTests < 10) std::cout << tag << " FAIL: fsyrk threads " << nrThreads << " beta " << beta << " element " << i << ',' << j << ' ' << C[i][j] << " instead of " << ref << '\n';
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	std::cout << tag << " n " << n << " k " << k << " rank updates " << (nrOfFailedTests ? "FAIL" : "PASS") << '\n';
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	int nrOfFailedTestCases = 0;
+
+	std::mt19937_64 rng(25);
+	// sizes around the column chunk of the rank-1 updates and the tile of the rank-k update
+	for (size_t n : { size_t(1), size_t(63), size_t(130), size_t(300) }) {
+		nrOfFailedTestCases += VerifyRankUpdates<8, 0>("posit<8,0> ", rng, n, 7);
+		nrOfFailedTestCases += VerifyRankUpdates<16, 1>("posit<16,1>", rng, n, 16);
+		nrOfFailedTestCases += VerifyRankUpdates<32, 2>("posit<32,2>", rng, n, 33);
+		nrOfFailedTestCases += VerifyRankUpdates<24, 1>("posit<24,1>", rng, n, 5);
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const sw::universal::posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
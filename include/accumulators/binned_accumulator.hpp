@@ -0,0 +1,181 @@
+#pragma once
+// binned_accumulator.hpp: reproducible summation of IEEE floating-point values
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <bit>
+#include <limits>
+#include <type_traits>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ binned_accumulator implements the binned summation of Demmel and Nguyen, as used by ReproBLAS.
+
+ The exponent range is cut into bins of W bits at fixed positions: bin b collects multiples of
+ 2^(b*W). Every value is split, by rounding against a fixed extractor, into a deposit for the
+ highest bin it reaches and remainders for the bins below; the accumulator keeps the Fold highest
+ bins reached so far. Each deposit is a multiple of the bin grid and is added exactly, so the
+ content of every bin depends only on the set of values summed, not on their order or on how the
+ summation is split across threads. The result is rounded from the bins in a fixed order, and is
+ therefore bitwise reproducible.
+
+ The bin of a value is a primary S in [E, 2E), E = 2^(b*W + p - 1), whose ulp is the bin grid,
+ plus a carry count of 0.25E units that is updated when S is renormalized. Setting the last bit of
+ the value before it is rounded against S avoids ties, so the rounding does not depend on S.
+ Bins near the top of the exponent range are held scaled down by 2^-c to stay finite.
+ */
+template<typename Real, size_t Fold = 3>
+class binned_accumulator {
+public:
+	static_assert(std::is_same_v<Real, float> || std::is_same_v<Real, double>, "binned_accumulator requires float or double");
+	static_assert(Fold >= 2, "binned_accumulator requires at least two folds");
+	using Bits = std::conditional_t<std::is_same_v<Real, float>, uint32_t, uint64_t>;
+	static constexpr int p = std::numeric_limits<Real>::digits;             // 24 or 53
+	static constexpr int W = (p == 53 ? 40 : 13);                           // bin width
+	static constexpr int minExp = std::numeric_limits<Real>::min_exponent - 1;   // smallest normal 2^minExp
+	static constexpr int maxExp = std::numeric_limits<Real>::max_exponent;       // overflow threshold 2^maxExp
+	// lowest bin whose primary is a normal number
+	static constexpr int minBin = -((p - 1 - minExp) / W);
+	// deposits between renormalizations, such that a primary cannot leave [E, 2E)
+	static constexpr size_t renormInterval = (size_t(1) << (p - W - 2)) - 1;
+
+	binned_accumulator() { clear(); }
+
+	void clear() {
+		_top = minBin + int(Fold) - 1;
+		for (size_t j = 0; j < Fold; ++j) {
+			_primary[j] = extractor(_top - int(j));
+			_carry[j] = 0;
+		}
+		_deposits = 0;
+		_special = 0;
+	}
+
+	// add a value
+	binned_accumulator& operator+=(Real x) {
+		if (!std::isfinite(x)) { _special += x; return *this; }
+		if (x == 0) return *this;
+		int b = bin_of(x);
+		if (b > _top) raise(b);
+		for (size_t j = 0; j < Fold; ++j) {
+			int bin = _top - int(j);
+			if (bin < minBin) break;
+			int c = scaling(bin);
+			Real xs = (c ? std::ldexp(x, -c) : x);
+			Real s = _primary[j];
+			_primary[j] = s + with_last_bit(xs);
+			Real d = _primary[j] - s;       // exact deposit in the scaled domain
+			if (d == 0) continue;           // x is below the grid of this bin
+			// a non-zero deposit implies xs is normal and exact, so the remainder is exact too
+			x = (c ? std::ldexp(xs - d, c) : xs - d);
+			if (x == 0) break;
+		}
+		if (++_deposits == renormInterval) renormalize();
+		return *this;
+	}
+	binned_accumulator& operator-=(Real x) { return *this += -x; }
+
+	// add the product a * b as its rounded value and its rounding error, which together are exact
+	// unless the product underflows; either way both terms depend only on a and b
+	void fma(Real a, Real b) {
+		Real p = a * b;
+		*this += p;
+		if (std::isfinite(p)) *this += std::fma(a, b, -p);
+	}
+
+	// merge the bins of another accumulator; merging is exact
+	binned_accumulator& operator+=(const binned_accumulator& rhs) {
+		binned_accumulator r = rhs;
+		if (r._top > _top) raise(r._top);
+		if (_top > r._top) r.raise(_top);
+		renormalize();
+		r.renormalize();
+		for (size_t j = 0; j < Fold; ++j) {
+			_primary[j] += (r._primary[j] - extractor(_top - int(j)));   // both differences lie in [-0.25E, 0.25E)
+			_carry[j] += r._carry[j];
+		}
+		renormalize();
+		_special += r._special;
+		return *this;
+	}
+
+	// round the content of the bins, from the top down, to a Real
+	Real value() const {
+		if (_special != 0 || std::isnan(_special)) return _special;
+		binned_accumulator q = *this;
+		q.renormalize();
+		Real sum = 0;
+		for (size_t j = 0; j < Fold; ++j) {
+			int bin = q._top - int(j);
+			if (bin < minBin) break;
+			int c = scaling(bin);
+			Real E = extractor(bin) / Real(1.5);
+			Real carryTerm = Real(q._carry[j]) * (E / Real(4));
+			Real primaryTerm = q._primary[j] - extractor(bin);
+			sum += (c ? std::ldexp(carryTerm, c) : carryTerm);
+			sum += (c ? std::ldexp(primaryTerm, c) : primaryTerm);
+		}
+		return sum;
+	}
+
+private:
+	Real    _primary[Fold];   // _primary[j] belongs to bin _top - j
+	int64_t _carry[Fold];     // in units of 0.25 * E of the bin
+	int     _top;             // highest bin held
+	size_t  _deposits;        // deposits since the last renormalization
+	Real    _special;         // sum of the infinities and NaNs
+
+	// scale exponent of a bin: keeps 2E of the top bins below the overflow threshold
+	static int scaling(int bin) {
+		int c = bin * W + p + 1 - maxExp;
+		return (c > 0 ? c : 0);
+	}
+	// 1.5 * E, in the scaled domain of the bin
+	static Real extractor(int bin) {
+		return std::ldexp(Real(1.5), bin * W + p - 1 - scaling(bin));
+	}
+	// bin of a finite, non-zero value: the lowest bin b with |x| < 2^((b+1)W - 1)
+	static int bin_of(Real x) {
+		int e = std::ilogb(x);          // |x| in [2^e, 2^(e+1))
+		int b = (e + 2 + W - 1 + W * 64) / W - 1 - 64;   // ceil((e + 2) / W) - 1, offset to keep the division non-negative
+		return (b < minBin ? minBin : b);
+	}
+	// x with its last significand bit set, so that rounding against a primary never ties
+	static Real with_last_bit(Real x) {
+		return std::bit_cast<Real>(Bits(std::bit_cast<Bits>(x) | Bits(1)));
+	}
+	// move the window of bins up so that its top is bin b; the dropped bins would not have been reached
+	void raise(int b) {
+		int shift = b - _top;
+		for (int j = int(Fold) - 1; j >= 0; --j) {
+			if (j - shift >= 0) {
+				_primary[j] = _primary[j - shift];
+				_carry[j] = _carry[j - shift];
+			}
+			else {
+				_primary[j] = extractor(b - j);
+				_carry[j] = 0;
+			}
+		}
+		_top = b;
+	}
+	// bring every primary back into [1.25E, 1.75E)
+	void renormalize() {
+		for (size_t j = 0; j < Fold; ++j) {
+			int bin = _top - int(j);
+			Real M = extractor(bin);
+			Real quarter = M / Real(6);    // 0.25 * E
+			if (_primary[j] >= M + quarter) { _primary[j] -= quarter; ++_carry[j]; }
+			else if (_primary[j] < M - quarter) { _primary[j] += quarter; --_carry[j]; }
+		}
+		_deposits = 0;
+	}
+};
+
+}} // namespace sw::hprblas
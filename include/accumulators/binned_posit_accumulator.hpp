@@ -0,0 +1,188 @@
+#pragma once
+// binned_posit_accumulator.hpp: reproducible summation of posits in a few integer bins
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+#include <bit>
+#include <universal/number/posit/posit.hpp>
+#include <quire/posit_decode.hpp>
+#include <quire/limb_accumulator.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ binned_posit_accumulator is the binned summation of Demmel and Nguyen, carried over to the
+ fixed-point view of the quire: the binary weights 2^i are cut into bins of W bits at fixed
+ positions, bin b holds the weights [2^(b*W), 2^((b+1)*W)), and the accumulator keeps only the
+ Fold highest bins reached so far, each an integer sum of W-bit chunks.
+
+ A value, or an exact product, contributes to bin b the chunk of W bits of its magnitude that falls
+ into the bin, with the sign of the value; the bits below the lowest bin held are dropped. The chunk
+ depends only on the value and on b, and a value never reaches bins above the bin of its leading
+ bit, so every bin held sums the same chunks whatever the order of the values or the split of the
+ summation across threads. Moving the window up to a new top bin drops the lowest bins as a whole,
+ and the bins kept are unaffected. The sum is rounded once, from the exact content of the bins.
+
+ The error of the sum is below n * 2^((top - Fold + 1) * W), that is n * 2^(-(Fold - 1) * W) times
+ the largest magnitude accumulated. With the default W = 32 and Fold = 3 the accumulator is a few
+ dozen bytes, against the 2^(es+2) * (nbits - 2) bits of a quire: 248 bytes for posit<64,3>.
+ This accumulator is restricted to posits with nbits <= 64, the range of the posit decoder.
+ */
+template<size_t nbits, size_t es, size_t Fold = 3>
+class binned_posit_accumulator {
+public:
+	static_assert(Fold >= 2, "binned_posit_accumulator requires at least two folds");
+	static constexpr size_t fbits = nbits - 3 - es;
+	static constexpr int W = 32;                                            // bin width
+	static constexpr size_t renormInterval = size_t(1) << (62 - W);        // deposits a bin absorbs before its carry is split off
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es>;
+
+	binned_posit_accumulator() { clear(); }
+	binned_posit_accumulator(int i) { clear(); *this += Scalar(i); }
+
+	void clear() {
+		_top = INT_MIN;
+		for (size_t j = 0; j < Fold; ++j) _bin[j] = _carry[j] = 0;
+		_deposits = 0;
+		_nar = false;
+	}
+	void reset() { clear(); }
+	bool iszero() const {
+		if (_nar) return false;
+		for (size_t j = 0; j < Fold; ++j) if (_bin[j] != 0 || _carry[j] != 0) return false;
+		return true;
+	}
+
+	binned_posit_accumulator& operator+=(const Scalar& p) {
+		decoded_posit d = decode_posit(p);
+		if (d.nar) { _nar = true; return *this; }
+		if (d.significand == 0) return *this;
+		deposit(d.sign, 0, d.significand, d.scale - int(fbits));
+		return *this;
+	}
+	binned_posit_accumulator& operator-=(const Scalar& p) { return *this += -p; }
+
+	// accumulate the exact product a * b
+	void fma(const Scalar& a, const Scalar& b) {
+		decoded_posit da = decode_posit(a);
+		decoded_posit db = decode_posit(b);
+		if (da.nar || db.nar) { _nar = true; return; }
+		if (da.significand == 0 || db.significand == 0) return;
+		uint64_t hi, lo;
+		multiply(da.significand, db.significand, hi, lo);
+		deposit(da.sign != db.sign, hi, lo, da.scale + db.scale - 2 * int(fbits));
+	}
+
+	// merge the bins of another accumulator; merging is exact
+	binned_posit_accumulator& operator+=(const binned_posit_accumulator& rhs) {
+		_nar |= rhs._nar;
+		if (rhs._top == INT_MIN) return *this;
+		if (rhs._top > _top) raise(rhs._top);
+		for (size_t j = 0; j < Fold; ++j) {
+			int k = int(j) - (_top - rhs._top);          // bin of rhs at the position of bin j
+			if (k < 0) continue;
+			_bin[j] += rhs._bin[k];
+			_carry[j] += rhs._carry[k];
+		}
+		renormalize();
+		return *this;
+	}
+
+	// the exact content of the bins, in the value type of the reference quire, for the one rounding step
+	auto to_value() const {
+		limb_accumulator<(int(Fold) * W + 64 + W + 63) / 64 + 1> acc;
+		if (_nar || _top == INT_MIN) return accumulator_to_value<Reference>(acc, 0, _nar);
+		for (size_t j = 0; j < Fold; ++j) {
+			int shift = (int(Fold) - 1 - int(j)) * W;   // bin _top - j relative to the lowest bin held
+			if (_bin[j]) acc.accumulate(_bin[j] < 0, magnitude(_bin[j]), shift);
+			if (_carry[j]) acc.accumulate(_carry[j] < 0, magnitude(_carry[j]), shift + W);
+		}
+		return accumulator_to_value<Reference>(acc, -(_top - int(Fold) + 1) * W, false);
+	}
+
+private:
+	int64_t _bin[Fold];       // _bin[j] belongs to bin _top - j
+	int64_t _carry[Fold];     // in units of 2^W of the bin
+	int     _top;             // highest bin held, INT_MIN when nothing has been accumulated
+	size_t  _deposits;        // deposits since the last renormalization
+	bool    _nar;
+
+	static uint64_t magnitude(int64_t v) { return (v < 0 ? uint64_t(0) - uint64_t(v) : uint64_t(v)); }
+	static int floor_div(int a, int b) { return (a >= 0 ? a / b : -((-a + b - 1) / b)); }
+
+	// full 128-bit product of two significands
+	static void multiply(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo) {
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 p = (unsigned __int128)a * b;
+		hi = uint64_t(p >> 64);
+		lo = uint64_t(p);
+#else
+		uint64_t a0 = a & 0xFFFFFFFFu, a1 = a >> 32, b0 = b & 0xFFFFFFFFu, b1 = b >> 32;
+		uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+		uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFFu) + (p10 & 0xFFFFFFFFu);
+		lo = (mid << 32) | (p00 & 0xFFFFFFFFu);
+		hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+	}
+	// the W bits of hi:lo starting at bit s, which may be negative
+	static int64_t chunk(uint64_t hi, uint64_t lo, int s) {
+		constexpr uint64_t mask = (uint64_t(1) << W) - 1;
+		if (s <= -W || s >= 128) return 0;
+		if (s < 0) return int64_t((lo << -s) & mask);
+		if (s == 0) return int64_t(lo & mask);
+		if (s < 64) return int64_t(((lo >> s) | (hi << (64 - s))) & mask);
+		return int64_t((hi >> (s - 64)) & mask);
+	}
+	// add (-1)^negative * hi:lo * 2^e to the bins it reaches
+	void deposit(bool negative, uint64_t hi, uint64_t lo, int e) {
+		int msb = e + (hi ? 127 - std::countl_zero(hi) : 63 - std::countl_zero(lo));
+		int b = floor_div(msb, W);
+		if (b > _top) raise(b);
+		for (size_t j = 0; j < Fold; ++j) {
+			int64_t c = chunk(hi, lo, (_top - int(j)) * W - e);
+			_bin[j] += (negative ? -c : c);
+		}
+		if (++_deposits == renormInterval) renormalize();
+	}
+	// move the window of bins up so that its top is bin b; the dropped bins are discarded
+	void raise(int b) {
+		if (_top == INT_MIN) {
+			_top = b;
+			return;
+		}
+		int shift = b - _top;
+		for (int j = int(Fold) - 1; j >= 0; --j) {
+			if (j - shift >= 0) {
+				_bin[j] = _bin[j - shift];
+				_carry[j] = _carry[j - shift];
+			}
+			else {
+				_bin[j] = _carry[j] = 0;
+			}
+		}
+		_top = b;
+	}
+	// split the high part of every bin off into its carry, leaving the content of the bin unchanged
+	void renormalize() {
+		for (size_t j = 0; j < Fold; ++j) {
+			int64_t high = _bin[j] >> W;       // arithmetic shift: floor division by 2^W
+			_carry[j] += high;
+			_bin[j] -= int64_t(uint64_t(high) << W);
+		}
+		_deposits = 0;
+	}
+};
+
+// quire_fma accumulates the exact product a * b into a binned posit accumulator
+template<size_t nbits, size_t es, size_t Fold>
+inline void quire_fma(binned_posit_accumulator<nbits, es, Fold>& q, const sw::universal::posit<nbits, es>& a, const sw::universal::posit<nbits, es>& b) {
+	q.fma(a, b);
+}
+
+}} // namespace sw::hprblas
@@ -0,0 +1,298 @@
+#pragma once
+// kulisch_accumulator.hpp: exact accumulation of IEEE floating-point products
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <bit>
+#include <limits>
+#include <type_traits>
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+#include <quire/limb_accumulator.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ kulisch_accumulator is a superaccumulator for IEEE float and double: a two's complement fixed-point
+ number wide enough to hold every product of two finite values, from denorm_min^2 to max^2, plus
+ capacity bits for carries. Products and values are added exactly, so the content depends only on
+ the multiset of values accumulated, and value() rounds it once, to nearest even.
+
+ Decomposed, a finite value is m * 2^e with an integer m < 2^p and e >= eMin, the exponent of
+ denorm_min. Bit 0 of the accumulator has weight 2^(2 * eMin), and a product of two significands,
+ at most 2p bits, is added into a window of three limbs.
+
+ fma_block() has a vectorized fast path for the common case of operands of moderate magnitude.
+ Products are formed in double precision lanes, with the exact error term of double products
+ from a fused multiply-subtract, and summed into a floating-point expansion with error-free
+ TwoSum steps. Only the remainders that fall out of the expansion, which are rare when the
+ exponents of the products are close, and the expansion itself at the end of the block, are
+ added to the accumulator. Lanes with operands outside of the safe range take the exact scalar path.
+
+ Infinities and NaNs are summed separately, and dominate the result.
+ */
+
+namespace detail {
+
+#if defined(__AVX512F__)
+#define HPRBLAS_KULISCH_SIMD 1
+struct kulisch_lanes {
+	using type = __m512d;
+	static constexpr size_t width = 8;
+	static constexpr unsigned all = 0xFF;
+	static type load(const double* p) { return _mm512_loadu_pd(p); }
+	static type load(const float* p) { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+	static void store(double* p, type v) { _mm512_storeu_pd(p, v); }
+	static type zero() { return _mm512_setzero_pd(); }
+	static type broadcast(double a) { return _mm512_set1_pd(a); }
+	static type add(type a, type b) { return _mm512_add_pd(a, b); }
+	static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+	static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+	static type product_error(type a, type b, type p) { return _mm512_fmsub_pd(a, b, p); }
+	static unsigned nonzero(type v) { return _mm512_cmp_pd_mask(v, zero(), _CMP_NEQ_UQ); }
+	// lanes that are zero, or whose magnitude lies in [lo, hi]
+	static unsigned within(type v, type lo, type hi) {
+		type m = _mm512_abs_pd(v);
+		return (_mm512_cmp_pd_mask(m, lo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(m, hi, _CMP_LE_OQ)) | _mm512_cmp_pd_mask(v, zero(), _CMP_EQ_OQ);
+	}
+};
+#elif defined(__AVX2__) && defined(__FMA__)
+#define HPRBLAS_KULISCH_SIMD 1
+struct kulisch_lanes {
+	using type = __m256d;
+	static constexpr size_t width = 4;
+	static constexpr unsigned all = 0xF;
+	static type load(const double* p) { return _mm256_loadu_pd(p); }
+	static type load(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+	static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+	static type zero() { return _mm256_setzero_pd(); }
+	static type broadcast(double a) { return _mm256_set1_pd(a); }
+	static type add(type a, type b) { return _mm256_add_pd(a, b); }
+	static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+	static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+	static type product_error(type a, type b, type p) { return _mm256_fmsub_pd(a, b, p); }
+	static unsigned nonzero(type v) { return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(v, zero(), _CMP_NEQ_UQ))); }
+	// lanes that are zero, or whose magnitude lies in [lo, hi]
+	static unsigned within(type v, type lo, type hi) {
+		type m = _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+		type in = _mm256_and_pd(_mm256_cmp_pd(m, lo, _CMP_GE_OQ), _mm256_cmp_pd(m, hi, _CMP_LE_OQ));
+		return unsigned(_mm256_movemask_pd(_mm256_or_pd(in, _mm256_cmp_pd(v, zero(), _CMP_EQ_OQ))));
+	}
+};
+#endif
+
+} // namespace detail
+
+template<typename Real, size_t capacity = 64>
+class kulisch_accumulator {
+public:
+	static_assert(std::is_same_v<Real, float> || std::is_same_v<Real, double>, "kulisch_accumulator requires float or double");
+	static constexpr int p = std::numeric_limits<Real>::digits;                        // 24 or 53
+	static constexpr int eMin = std::numeric_limits<Real>::min_exponent - p;           // denorm_min = 2^eMin
+	static constexpr int eMax = std::numeric_limits<Real>::max_exponent - p;           // max = (2^p - 1) * 2^eMax
+	static constexpr int minNormalExp = std::numeric_limits<Real>::min_exponent - 1;   // min = 2^minNormalExp
+	// bit 0 has the weight 2^(2 * eMin) of the smallest product
+	static constexpr int offset = -2 * eMin;
+	// products are below 2^(2 * (eMax + p))
+	static constexpr size_t nrBits = size_t(2 * (eMax + p) + offset) + capacity + 1;
+	using Accumulator = limb_accumulator<(nrBits + 63) / 64>;
+	static constexpr size_t nlimbs = Accumulator::nrLimbs;
+	// the largest product is deposited at shift 2 * eMax + offset; its three-limb window must end within the accumulator
+	static_assert(((2 * eMax + offset) >> 6) + 2 < int(nlimbs), "kulisch_accumulator product window exceeds the accumulator");
+	// number of doubles in the floating-point expansion of the vectorized fast path
+	static constexpr size_t expansion = 4;
+
+	kulisch_accumulator() : _special(0) {}
+
+	void reset() { _acc.clear(); _special = 0; }
+	void clear() { reset(); }
+	bool iszero() const { return _acc.iszero() && _special == 0; }
+
+	// accumulate the exact product a * b
+	void fma(Real a, Real b) {
+		if (!std::isfinite(a) || !std::isfinite(b)) { _special += a * b; return; }
+		bool signA, signB;
+		uint64_t mA, mB;
+		int eA, eB;
+		split(a, signA, mA, eA);
+		split(b, signB, mB, eB);
+		if (mA == 0 || mB == 0) return;
+		deposit(signA != signB, mA, mB, eA + eB + offset);
+	}
+	// accumulate the exact products x[i] * y[i], i in [0, n)
+	void fma_block(size_t n, const Real* x, const Real* y) {
+		size_t i = 0;
+#if defined(HPRBLAS_KULISCH_SIMD)
+		using L = detail::kulisch_lanes;
+		constexpr size_t w = L::width;
+		if (n >= w) {
+			// double products of operands in [2^-450, 2^450] are normal, their error terms are exact, and sums cannot overflow;
+			// float products are exact in double precision
+			typename L::type lo = L::broadcast(std::is_same_v<Real, double> ? std::ldexp(1.0, -450) : 0.0);
+			typename L::type hi = L::broadcast(std::is_same_v<Real, double> ? std::ldexp(1.0, 450) : double(std::numeric_limits<float>::max()));
+			typename L::type fpe[expansion];
+			for (size_t j = 0; j < expansion; ++j) fpe[j] = L::zero();
+			for (; i + w <= n; i += w) {
+				typename L::type a = L::load(x + i), b = L::load(y + i);
+				if ((L::within(a, lo, hi) & L::within(b, lo, hi)) != L::all) {
+					for (size_t k = i; k < i + w; ++k) fma(x[k], y[k]);
+					continue;
+				}
+				typename L::type prod = L::mul(a, b);
+				expand(fpe, prod);
+				if constexpr (std::is_same_v<Real, double>) expand(fpe, L::product_error(a, b, prod));
+			}
+			for (size_t j = 0; j < expansion; ++j) flush(fpe[j]);
+		}
+#endif
+		for (; i < n; ++i) fma(x[i], y[i]);
+	}
+	kulisch_accumulator& operator+=(Real v) {
+		if (!std::isfinite(v)) { _special += v; return *this; }
+		bool sign;
+		uint64_t m;
+		int e;
+		split(v, sign, m, e);
+		if (m != 0) deposit(sign, m, 1, e + offset);
+		return *this;
+	}
+	kulisch_accumulator& operator-=(Real v) { return *this += -v; }
+	// merging is exact
+	kulisch_accumulator& operator+=(const kulisch_accumulator& rhs) { _acc += rhs._acc; _special += rhs._special; return *this; }
+	kulisch_accumulator& operator-=(const kulisch_accumulator& rhs) { _acc -= rhs._acc; _special -= rhs._special; return *this; }
+
+	// round the exact content to nearest, ties to even
+	Real value() const {
+		if (_special != 0 || std::isnan(_special)) return _special;
+		if (_acc.iszero()) return Real(0);
+		Accumulator magnitude = _acc;
+		bool negative = magnitude.isneg();
+		if (negative) magnitude.negate();
+		int msb = magnitude.msb();
+		// position of the unit in the last place: p significant bits, or fewer for a subnormal result
+		int lsb = (msb - offset >= minNormalExp) ? msb - (p - 1) : eMin + offset;
+		uint64_t significand = extract(magnitude, lsb, msb - lsb + 1);
+		bool round = magnitude.test(size_t(lsb - 1));
+		bool sticky = any_below(magnitude, lsb - 1);
+		if (round && (sticky || (significand & 1))) ++significand;
+		Real result = std::ldexp(Real(significand), lsb - offset);   // overflows to infinity
+		return negative ? -result : result;
+	}
+
+private:
+	Accumulator _acc;
+	Real        _special;   // sum of the products that involve infinities and NaNs
+
+	// finite v = (-1)^sign * m * 2^e, with m < 2^p and e >= the denorm_min exponent of F
+	template<typename F>
+	static void split(F v, bool& sign, uint64_t& m, int& e) {
+		using Bits = std::conditional_t<std::is_same_v<F, float>, uint32_t, uint64_t>;
+		constexpr int fp = std::numeric_limits<F>::digits;
+		constexpr int fMin = std::numeric_limits<F>::min_exponent - fp;
+		Bits bits = std::bit_cast<Bits>(v);
+		sign = (bits >> (8 * sizeof(F) - 1)) != 0;
+		int biased = int((bits >> (fp - 1)) & ((Bits(1) << (8 * sizeof(F) - fp)) - 1));
+		m = uint64_t(bits & ((Bits(1) << (fp - 1)) - 1));
+		if (biased) m |= uint64_t(1) << (fp - 1);
+		e = (biased ? biased - 1 : 0) + fMin;
+	}
+	// add or subtract mA * mB * 2^shift; bits below 2^0 are zero when shift is negative
+	void deposit(bool negative, uint64_t mA, uint64_t mB, int shift) {
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 m = static_cast<unsigned __int128>(mA) * mB;
+		if (shift < 0) {
+			m >>= unsigned(-shift);
+			shift = 0;
+		}
+		uint64_t* limb = _acc.limbs();
+		size_t i = size_t(shift) >> 6;
+		unsigned o = unsigned(shift & 63);
+		unsigned __int128 low = m << o;                         // m < 2^106, so m << o loses at most 41 bits
+		uint64_t high = (o ? uint64_t(m >> (128 - o)) : 0);      // the bits above the two-limb window
+		unsigned __int128 w = (static_cast<unsigned __int128>(limb[i + 1]) << 64) | limb[i];
+		bool carry;
+		if (negative) {
+			unsigned __int128 d = w - low;
+			carry = (d > w);
+			w = d;
+			limb[i] = uint64_t(w);
+			limb[i + 1] = uint64_t(w >> 64);
+			uint64_t d2 = high + (carry ? 1 : 0);                   // high < 2^41 cannot wrap
+			carry = (limb[i + 2] < d2);
+			limb[i + 2] -= d2;
+			for (i += 3; carry && i < nlimbs; ++i) carry = (limb[i]-- == 0);
+		}
+		else {
+			unsigned __int128 s = w + low;
+			carry = (s < low);
+			w = s;
+			limb[i] = uint64_t(w);
+			limb[i + 1] = uint64_t(w >> 64);
+			uint64_t s2 = high + (carry ? 1 : 0);
+			limb[i + 2] += s2;
+			carry = (limb[i + 2] < s2);
+			for (i += 3; carry && i < nlimbs; ++i) carry = (++limb[i] == 0);
+		}
+#else
+		// four partial products of the 32-bit halves of the significands, each below 2^64
+		uint64_t a0 = mA & 0xFFFFFFFFull, a1 = mA >> 32;
+		uint64_t b0 = mB & 0xFFFFFFFFull, b1 = mB >> 32;
+		_acc.accumulate(negative, a0 * b0, shift);
+		_acc.accumulate(negative, a0 * b1, shift + 32);
+		_acc.accumulate(negative, a1 * b0, shift + 32);
+		_acc.accumulate(negative, a1 * b1, shift + 64);
+#endif
+	}
+#if defined(HPRBLAS_KULISCH_SIMD)
+	// add the lanes of v to the expansion with TwoSum steps, and deposit what falls out of it
+	void expand(typename detail::kulisch_lanes::type* fpe, typename detail::kulisch_lanes::type v) {
+		using L = detail::kulisch_lanes;
+		for (size_t j = 0; j < expansion; ++j) {
+			typename L::type s = L::add(fpe[j], v);
+			typename L::type bb = L::sub(s, fpe[j]);
+			v = L::add(L::sub(fpe[j], L::sub(s, bb)), L::sub(v, bb));
+			fpe[j] = s;
+		}
+		if (L::nonzero(v)) flush(v);
+	}
+	// deposit the lanes of v; every lane is an integer multiple of 2^(2 * eMin)
+	void flush(typename detail::kulisch_lanes::type v) {
+		using L = detail::kulisch_lanes;
+		double lane[L::width];
+		L::store(lane, v);
+		for (size_t k = 0; k < L::width; ++k) {
+			if (lane[k] == 0) continue;
+			bool sign;
+			uint64_t m;
+			int e;
+			split(lane[k], sign, m, e);
+			deposit(sign, m, 1, e + offset);
+		}
+	}
+#endif
+	// count <= 64 bits of the accumulator starting at bit position lsb
+	static uint64_t extract(const Accumulator& acc, int lsb, int count) {
+		size_t i = size_t(lsb) >> 6;
+		unsigned o = unsigned(lsb & 63);
+		uint64_t v = acc.limb(i) >> o;
+		if (o && i + 1 < nlimbs) v |= acc.limb(i + 1) << (64 - o);
+		return (count >= 64 ? v : v & ((uint64_t(1) << count) - 1));
+	}
+	// any bit set below bit position pos
+	static bool any_below(const Accumulator& acc, int pos) {
+		if (pos <= 0) return false;
+		size_t i = size_t(pos) >> 6;
+		unsigned o = unsigned(pos & 63);
+		if (o && (acc.limb(i) & ((uint64_t(1) << o) - 1))) return true;
+		for (size_t j = 0; j < i; ++j) if (acc.limb(j)) return true;
+		return false;
+	}
+};
+
+}} // namespace sw::hprblas
@@ -6,38 +6,282 @@
 // This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
 #include <universal/number/posit/posit.hpp>
 #include <boost/numeric/mtl/mtl.hpp>
+#include <parallel/thread_pool.hpp>
+#include <quire/quire_traits.hpp>
+#include <quire/posit_panel.hpp>
+#include <quire/mixed_quire.hpp>
+#include <quire/complex_quire.hpp>
+#include <quire/quire_serialization.hpp>
+#include <accumulators/binned_accumulator.hpp>
+#include <accumulators/binned_posit_accumulator.hpp>
+#include <accumulators/kulisch_accumulator.hpp>
+#include <kernels/contiguous_level1.hpp>
+#include <kernels/strided_gather.hpp>
+#include <kernels/magnitude_search.hpp>
 
 namespace sw {
 namespace hprblas {
 
 // LEVEL 1 BLAS operators
 
-// 1-norm of a vector: sum of magnitudes of the vector elements, default increment stride is 1
+// vector types whose elements are stored contiguously
+template<typename Vector>
+struct is_contiguous_vector : std::false_type {};
+template<typename Scalar, typename Allocator>
+struct is_contiguous_vector< std::vector<Scalar, Allocator> > : std::true_type {};
+template<typename... Parameters>
+struct is_contiguous_vector< mtl::vec::dense_vector<Parameters...> > : std::true_type {};
 template<typename Vector>
-typename Vector::value_type asum(size_t n, const Vector& x, size_t incx = 1) {
-	typename Vector::value_type sum = 0;
-	size_t ix;
-	for (ix = 0; ix < n; ix += incx) {
-		sum += (x[ix] < 0 ? -x[ix] : x[ix]);
+constexpr bool is_contiguous_vector_v = is_contiguous_vector<Vector>::value;
+
+///
+/// reproducible reductions
+/// Posit elements are accumulated in a quire, float and double elements in a binned_accumulator.
+/// Both accumulate exactly, or deterministically, per element and merge exactly, so the index range
+/// is split into blocks over the thread pool and the result is bitwise identical for any thread count.
+/// The accumulation mode of a call trades the exact result of the quire for the smaller binned accumulators.
+
+// minimum number of elements a worker reduces before it is worth splitting the range
+constexpr size_t HPRBLAS_REDUCTION_PARALLEL_GRAIN = 8192;
+
+// accumulation selects the accumulator of sum, asum, dot, and the norms for a call
+//   exact:    a quire for posits, a kulisch_accumulator for float and double; the exact result is rounded once
+//   binned:   a K-fold binned accumulator; the error is bounded instead of zero, but the result is still
+//             independent of element order and thread count, and the accumulator is a few dozen bytes
+//             for any posit configuration
+//   standard: the established behavior of the routine: exact, except for the float and double sum and asum,
+//             which are binned, and the posit dot product, which rounds every step; the float and double
+//             dot product is exact through the kulisch_accumulator
+enum class accumulation { standard, exact, binned };
+
+// accumulator of an accumulation mode for an element type
+template<accumulation Mode, typename Scalar>
+struct reduction_accumulator {
+	using type = std::conditional_t<Mode == accumulation::binned, binned_accumulator<Scalar>, kulisch_accumulator<Scalar> >;
+};
+template<accumulation Mode, size_t nbits, size_t es>
+struct reduction_accumulator< Mode, sw::universal::posit<nbits, es> > {
+	using type = std::conditional_t<Mode == accumulation::binned, binned_posit_accumulator<nbits, es>, fused_quire_t<nbits, es> >;
+};
+// Default resolves accumulation::standard for the calling routine
+template<accumulation Mode, typename Scalar, accumulation Default = accumulation::exact>
+using reduction_accumulator_t = typename reduction_accumulator<(Mode == accumulation::standard ? Default : Mode), Scalar>::type;
+
+// accumulate f(x[ix]) for ix = 0, incx, 2*incx, ... < n into an Accumulator, in parallel blocks
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Accumulator, typename Vector, typename Transform>
+Accumulator reproducible_reduce(size_t n, const Vector& x, size_t incx, size_t nrThreads, Transform f) {
+	size_t nrElements = (n + incx - 1) / incx;
+	size_t nrBlocks = nr_of_blocks(nrElements, nrThreads, HPRBLAS_REDUCTION_PARALLEL_GRAIN);
+	std::vector<Accumulator> partial(nrBlocks);
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+		size_t first, last;
+		block_range(nrElements, nrBlocks, b, first, last);
+		Accumulator acc;
+		for (size_t k = first; k < last; ++k) acc += f(x[k * incx]);
+		partial[b] = acc;
+	});
+	Accumulator acc = partial[0];
+	for (size_t b = 1; b < nrBlocks; ++b) acc += partial[b];   // exact merge
+	return acc;
+}
+
+// accumulate the products x[k*incx] * y[k*incy], k in [0, nrProducts), into an Accumulator, in parallel blocks
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Accumulator, typename Vector>
+Accumulator reproducible_dot(size_t nrProducts, const Vector& x, size_t incx, const Vector& y, size_t incy, size_t nrThreads) {
+	using Scalar = typename Vector::value_type;
+	size_t nrBlocks = nr_of_blocks(nrProducts, nrThreads, HPRBLAS_REDUCTION_PARALLEL_GRAIN);
+	std::vector<Accumulator> partial(nrBlocks);
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+		size_t first, last;
+		block_range(nrProducts, nrBlocks, b, first, last);
+		Accumulator acc;
+		auto accumulate = [&](size_t len, const Scalar* xb, size_t incxb, const Scalar* yb, size_t incyb) {
+			for (size_t k = 0; k < len; ++k) {
+				if constexpr (is_posit_v<Scalar>) quire_fma(acc, xb[k * incxb], yb[k * incyb]); else acc.fma(xb[k * incxb], yb[k * incyb]);
+			}
+		};
+		if constexpr (is_contiguous_vector_v<Vector>) {
+			if (incx == 1 && incy == 1) {
+				if (last > first) accumulate(last - first, &x[first], 1, &y[first], 1);
+			}
+			else if (last > first) {
+				packed_pairs(last - first, &x[first * incx], incx, &y[first * incy], incy, [&](size_t len, const Scalar* xb, const Scalar* yb) {
+					accumulate(len, xb, 1, yb, 1);
+				});
+			}
+		}
+		else {
+			for (size_t k = first; k < last; ++k) {
+				if constexpr (is_posit_v<Scalar>) quire_fma(acc, x[k * incx], y[k * incy]); else acc.fma(x[k * incx], y[k * incy]);
+			}
+		}
+		partial[b] = acc;
+	});
+	Accumulator acc = partial[0];
+	for (size_t b = 1; b < nrBlocks; ++b) acc += partial[b];   // exact merge
+	return acc;
+}
+
+// 1-norm of a vector: sum of magnitudes of the vector elements, default increment stride is 1
+template<accumulation Mode = accumulation::standard, typename Vector>
+typename Vector::value_type asum(size_t n, const Vector& x, size_t incx = 1, size_t nrThreads = 0) {
+	using Scalar = typename Vector::value_type;
+	auto magnitude = [](const Scalar& v) { return (v < 0 ? -v : v); };
+	if constexpr (is_posit_v<Scalar>) {
+		auto q = reproducible_reduce< reduction_accumulator_t<Mode, Scalar> >(n, x, incx, nrThreads, magnitude);
+		Scalar sum;
+		sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the sum
+		return sum;
+	}
+	else if constexpr (is_ieee_binary_v<Scalar>) {
+		return reproducible_reduce< reduction_accumulator_t<Mode, Scalar, accumulation::binned> >(n, x, incx, nrThreads, magnitude).value();
+	}
+	else {
+		Scalar sum = 0;
+		size_t ix;
+		for (ix = 0; ix < n; ix += incx) {
+			sum += magnitude(x[ix]);
+		}
+		return sum;
 	}
-	return sum;
 }
 
 // sum of the vector elements, default increment stride is 1
+template<accumulation Mode = accumulation::standard, typename Vector>
+typename Vector::value_type sum(size_t n, const Vector& x, size_t incx = 1, size_t nrThreads = 0) {
+	using Scalar = typename Vector::value_type;
+	auto identity = [](const Scalar& v) { return v; };
+	if constexpr (is_posit_v<Scalar>) {
+		auto q = reproducible_reduce< reduction_accumulator_t<Mode, Scalar> >(n, x, incx, nrThreads, identity);
+		Scalar sum;
+		sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the sum
+		return sum;
+	}
+	else if constexpr (is_ieee_binary_v<Scalar>) {
+		return reproducible_reduce< reduction_accumulator_t<Mode, Scalar, accumulation::binned> >(n, x, incx, nrThreads, identity).value();
+	}
+	else {
+		Scalar sum = 0;
+		size_t ix;
+		for (ix = 0; ix < n; ix += incx) {
+			sum += x[ix];
+		}
+		return sum;
+	}
+}
+
+///
+/// reproducible prefix sums
+/// The scan runs in two passes over blocks of the index range. The first pass reduces every block
+/// into an exact accumulator, the carries into each block are merged exactly, and the second pass
+/// continues the carry of each block through its elements. Every prefix is the exact sum rounded once,
+/// so the output is correctly rounded and bitwise identical for any thread count.
+
+// prefix sums of n elements, y[k*incy] = sum of x[j*incx] for j <= k (inclusive) or j < k (exclusive)
+// y may alias x when incx == incy; nrThreads = 0 selects the size of the default thread pool
 template<typename Vector>
-typename Vector::value_type sum(size_t n, const Vector& x, size_t incx = 1) {
-	typename Vector::value_type sum = 0;
-	size_t ix;
-	for (ix = 0; ix < n; ix += incx) {
-		sum += x[ix];
+void scan(size_t n, const Vector& x, size_t incx, Vector& y, size_t incy, bool inclusive, size_t nrThreads = 0) {
+	using Scalar = typename Vector::value_type;
+	size_t cnt = std::min(std::min(n, (size_t(mtl::size(x)) + incx - 1) / incx), (size_t(mtl::size(y)) + incy - 1) / incy);
+	if (cnt == 0) return;
+	if constexpr (is_posit_v<Scalar> || is_ieee_binary_v<Scalar>) {
+		using Accumulator = reduction_accumulator_t<accumulation::exact, Scalar>;
+		auto round = [](const Accumulator& acc) {
+			if constexpr (is_posit_v<Scalar>) {
+				Scalar v;
+				sw::universal::convert(acc.to_value(), v);
+				return v;
+			}
+			else {
+				return acc.value();
+			}
+		};
+		size_t nrBlocks = nr_of_blocks(cnt, nrThreads, HPRBLAS_REDUCTION_PARALLEL_GRAIN);
+		std::vector<Accumulator> carry(nrBlocks);
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+			size_t first, last;
+			block_range(cnt, nrBlocks, b, first, last);
+			Accumulator acc;
+			for (size_t k = first; k < last; ++k) acc += x[k * incx];
+			carry[b] = acc;
+		});
+		// exclusive prefix of the block sums: carry[b] becomes the exact sum of the blocks before b
+		Accumulator running;
+		for (size_t b = 0; b < nrBlocks; ++b) {
+			Accumulator blockSum = carry[b];
+			carry[b] = running;
+			running += blockSum;
+		}
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+			size_t first, last;
+			block_range(cnt, nrBlocks, b, first, last);
+			Accumulator acc = carry[b];
+			for (size_t k = first; k < last; ++k) {
+				Scalar v = x[k * incx];
+				if (inclusive) {
+					acc += v;
+					y[k * incy] = round(acc);     // one and only rounding step of the prefix
+				}
+				else {
+					y[k * incy] = round(acc);
+					acc += v;
+				}
+			}
+		});
 	}
-	return sum;
+	else {
+		Scalar sum = 0;
+		for (size_t k = 0; k < cnt; ++k) {
+			Scalar v = x[k * incx];
+			if (inclusive) sum += v;
+			y[k * incy] = sum;
+			if (!inclusive) sum += v;
+		}
+	}
+}
+// inclusive prefix sum, y[k*incy] = x[0] + ... + x[k*incx]
+template<typename Vector>
+void inclusive_scan(size_t n, const Vector& x, size_t incx, Vector& y, size_t incy, size_t nrThreads = 0) {
+	scan(n, x, incx, y, incy, true, nrThreads);
+}
+// exclusive prefix sum, y[0] = 0 and y[k*incy] = x[0] + ... + x[(k-1)*incx]
+template<typename Vector>
+void exclusive_scan(size_t n, const Vector& x, size_t incx, Vector& y, size_t incy, size_t nrThreads = 0) {
+	scan(n, x, incx, y, incy, false, nrThreads);
+}
+
+///
+/// contiguous fast path
+/// Unit stride calls on dense vectors are routed to the kernels in contiguous_level1.hpp,
+/// which operate on the first min(n, size(x), size(y)) elements, as the strided loops do.
+
+// number of elements a unit stride operation on x and y touches
+template<typename Vector>
+inline size_t unit_stride_count(size_t n, const Vector& x, const Vector& y) {
+	using namespace mtl;
+	return std::min(n, std::min(size_t(size(x)), size_t(size(y))));
+}
+
+// number of elements ix = 0, incx, 2*incx, ... that lie below both n * incx and size(x)
+template<typename Vector>
+inline size_t strided_count(size_t n, const Vector& x, size_t incx) {
+	using namespace mtl;
+	return std::min(n, (size_t(size(x)) + incx - 1) / incx);
 }
 
 // a time x plus y
 template<typename Scalar, typename Vector>
 void axpy(size_t n, Scalar a, const Vector& x, size_t incx, Vector& y, size_t incy) {
 	using namespace mtl;
+	if constexpr (is_contiguous_vector_v<Vector>) {
+		if (incx == 1 && incy == 1) {
+			size_t cnt = unit_stride_count(n, x, y);
+			if (cnt > 0) contiguous_axpy(cnt, a, &x[0], &y[0]);
+			return;
+		}
+	}
 	size_t cnt, ix, iy;
 	for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < size(x) && iy < size(y); ++cnt, ix += incx, iy += incy) {
 		y[iy] += a * x[ix];
@@ -48,6 +292,13 @@ void axpy(size_t n, Scalar a, const Vector& x, size_t incx, Vector& y, size_t in
 template<typename Vector>
 void copy(size_t n, const Vector& x, size_t incx, Vector& y, size_t incy) {
 	using namespace mtl;
+	if constexpr (is_contiguous_vector_v<Vector>) {
+		if (incx == 1 && incy == 1) {
+			size_t cnt = unit_stride_count(n, x, y);
+			if (cnt > 0) contiguous_copy(cnt, &x[0], &y[0]);
+			return;
+		}
+	}
 	size_t cnt, ix, iy;
 	for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < size(x) && iy < size(y); ++cnt, ix += incx, iy += incy) {
 		y[iy] = x[ix];
@@ -57,73 +308,584 @@ void copy(size_t n, const Vector& x, size_t incx, Vector& y, size_t incy) {
 // adapter for STL vectors
 //template<typename Scalar> auto size(const std::vector<Scalar>& v) { return v.size(); }
 
+///
+/// reproducible IEEE dot products
+/// float and double products are accumulated exactly in a kulisch_accumulator. Blocks of the index range
+/// accumulate in parallel and merge exactly, so the result is correctly rounded for any thread count.
+
+// exact dot product of x[k*incx] * y[k*incy], k in [0, nrProducts), rounded once
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Vector>
+typename Vector::value_type kulisch_dot(size_t nrProducts, const Vector& x, size_t incx, const Vector& y, size_t incy, size_t nrThreads = 0) {
+	using Real = typename Vector::value_type;
+	using Accumulator = kulisch_accumulator<Real>;
+	if (nrProducts == 0) return Real(0);
+	size_t nrBlocks = nr_of_blocks(nrProducts, nrThreads, HPRBLAS_REDUCTION_PARALLEL_GRAIN);
+	std::vector<Accumulator> partial(nrBlocks);
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+		size_t first, last;
+		block_range(nrProducts, nrBlocks, b, first, last);
+		Accumulator& acc = partial[b];
+		if constexpr (is_contiguous_vector_v<Vector>) {
+			if (incx == 1 && incy == 1) {
+				acc.fma_block(last - first, &x[first], &y[first]);
+			}
+			else if (last > first) {
+				packed_pairs(last - first, &x[first * incx], incx, &y[first * incy], incy, [&](size_t len, const Real* xb, const Real* yb) {
+					acc.fma_block(len, xb, yb);
+				});
+			}
+			return;
+		}
+		for (size_t k = first; k < last; ++k) acc.fma(x[k * incx], y[k * incy]);
+	});
+	for (size_t b = 1; b < nrBlocks; ++b) partial[0] += partial[b];   // exact merge
+	return partial[0].value();       // one and only rounding step of the dot product
+}
+
+// dot product of nrProducts elements accumulated in the accumulator of an exact or binned accumulation mode
+template<accumulation Mode, typename Vector>
+typename Vector::value_type accumulated_dot(size_t nrProducts, const Vector& x, size_t incx, const Vector& y, size_t incy) {
+	using Scalar = typename Vector::value_type;
+	static_assert(Mode != accumulation::standard, "accumulated_dot requires an exact or binned accumulation mode");
+	if (nrProducts == 0) return Scalar(0);
+	if constexpr (is_ieee_binary_v<Scalar> && Mode == accumulation::exact) {
+		return kulisch_dot(nrProducts, x, incx, y, incy);
+	}
+	else if constexpr (is_ieee_binary_v<Scalar>) {
+		return reproducible_dot< reduction_accumulator_t<Mode, Scalar> >(nrProducts, x, incx, y, incy, 0).value();
+	}
+	else {
+		auto q = reproducible_dot< reduction_accumulator_t<Mode, Scalar> >(nrProducts, x, incx, y, incy, 0);
+		Scalar product;
+		sw::universal::convert(q.to_value(), product);     // one and only rounding step of the dot product
+		return product;
+	}
+}
+
 // dot product: the operator vector::x[index] is limited to uint32_t, so the arguments are limited to uint32_t as well
 // The library does support arbitrary posit configuration conversions, but to simplify the 
 // behavior of the dot product, the element type of the vectors x and y are declared to be the same.
+// The fused dot products fdp<qnbits, qes>(x, y) accept two different posit configurations.
 // TODO: investigate if the vector<> index is always a 32bit entity?
-template<typename Vector>
+template<accumulation Mode = accumulation::standard, typename Vector>
 typename Vector::value_type dot(size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy) {
 	using namespace mtl;
-	typename Vector::value_type product = 0;
-	size_t cnt, ix, iy;
-	for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < mtl::size(x) && iy < mtl::size(y); ++cnt, ix += incx, iy += incy) {
-		product += x[ix] * y[iy];
+	using Scalar = typename Vector::value_type;
+	if constexpr (is_ieee_binary_v<Scalar> || (is_posit_v<Scalar> && Mode != accumulation::standard)) {
+		constexpr accumulation mode = (Mode == accumulation::standard ? accumulation::exact : Mode);
+		return accumulated_dot<mode>(std::min(strided_count(n, x, incx), strided_count(n, y, incy)), x, incx, y, incy);
+	}
+	else {
+		typename Vector::value_type product = 0;
+		size_t cnt, ix, iy;
+		for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < mtl::size(x) && iy < mtl::size(y); ++cnt, ix += incx, iy += incy) {
+			product += x[ix] * y[iy];
+		}
+		return product;
 	}
-	return product;
 }
 // specialized dot product
-template<typename Vector>
+template<accumulation Mode = accumulation::standard, typename Vector>
 typename Vector::value_type dot(const Vector& x, const Vector& y) {
 	using namespace mtl;
-	typename Vector::value_type product = 0;
-	size_t cnt, ix, iy;
-	for (cnt = 0, ix = 0, iy = 0; cnt < mtl::size(x); ++cnt, ++ix, ++iy) {
-		product += x[ix] * y[iy];
+	using Scalar = typename Vector::value_type;
+	if constexpr (is_ieee_binary_v<Scalar> || (is_posit_v<Scalar> && Mode != accumulation::standard)) {
+		constexpr accumulation mode = (Mode == accumulation::standard ? accumulation::exact : Mode);
+		return accumulated_dot<mode>(mtl::size(x), x, 1, y, 1);
+	}
+	else {
+		typename Vector::value_type product = 0;
+		size_t cnt, ix, iy;
+		for (cnt = 0, ix = 0, iy = 0; cnt < mtl::size(x); ++cnt, ++ix, ++iy) {
+			product += x[ix] * y[iy];
+		}
+		return product;
 	}
-	return product;
 }
 ///
 /// fused dot product operators
 
+// Fused dot product with quire continuation over contiguous arrays of n elements
+template<typename Quire, typename Scalar>
+inline void fdp_qr(Quire& sum_of_products, size_t n, const Scalar* x, const Scalar* y) {
+	for (size_t i = 0; i < n; ++i) {
+		quire_fma(sum_of_products, x[i], y[i]);
+	}
+}
+// Fused dot product with quire continuation over the n products x[k*incx] * y[k*incy] of two arrays:
+// strided operands are gathered into contiguous blocks for the contiguous kernel
+template<typename Quire, typename Scalar>
+inline void fdp_qr(Quire& sum_of_products, size_t n, const Scalar* x, size_t incx, const Scalar* y, size_t incy) {
+	if (incx == 1 && incy == 1) {
+		fdp_qr(sum_of_products, n, x, y);
+		return;
+	}
+	packed_pairs(n, x, incx, y, incy, [&](size_t len, const Scalar* xb, const Scalar* yb) {
+		fdp_qr(sum_of_products, len, xb, yb);
+	});
+}
 // Fused dot product with quire continuation
 template<typename Quire, typename Vector>
 void fdp_qr(Quire& sum_of_products, size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy) {
+	if constexpr (is_contiguous_vector_v<Vector>) {
+		if (!sw::universal::_trace_quire_add) {
+			size_t nrProducts = std::min((n + incx - 1) / incx, (n + incy - 1) / incy);
+			if (nrProducts > 0) fdp_qr(sum_of_products, nrProducts, &x[0], incx, &y[0], incy);
+			return;
+		}
+	}
 	size_t ix, iy;
 	for (ix = 0, iy = 0; ix < n && iy < n; ix = ix + incx, iy = iy + incy) {
-		sum_of_products += sw::universal::quire_mul(x[ix], y[iy]);
+		quire_fma(sum_of_products, x[ix], y[iy]);
+	}
+}
+// Fused dot product with quire continuation over n entries of two decoded posit panels
+template<typename Quire, size_t nbits, size_t es>
+inline void fdp_qr(Quire& sum_of_products, size_t n, const posit_panel<nbits, es>& x, size_t xoffset, const posit_panel<nbits, es>& y, size_t yoffset) {
+	const uint32_t* xs = x.significand() + xoffset;
+	const int32_t*  xe = x.scale() + xoffset;
+	const uint8_t*  xf = x.flags() + xoffset;
+	const uint32_t* ys = y.significand() + yoffset;
+	const int32_t*  ye = y.scale() + yoffset;
+	const uint8_t*  yf = y.flags() + yoffset;
+	for (size_t i = 0; i < n; ++i) {
+		sum_of_products.fma_decoded(xs[i], xe[i], xf[i], ys[i], ye[i], yf[i]);
 	}
 }
 // Resolved fused dot product, with the option to control capacity bits in the quire
 template<typename Vector, size_t capacity = 10>
 typename Vector::value_type fdp_stride(size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy) {
-	constexpr size_t nbits = Vector::value_type::nbits;
-	constexpr size_t es = Vector::value_type::es;
-	sw::universal::quire<nbits, es, capacity> q(0);
-	size_t ix, iy;
-	for (ix = 0, iy = 0; ix < n && iy < n; ix = ix + incx, iy = iy + incy) {
-		q += sw::universal::quire_mul(x[ix], y[iy]);
-		if (sw::universal::_trace_quire_add) std::cout << q << '\n';
+	if constexpr (is_ieee_binary_v<typename Vector::value_type>) {
+		size_t nx = (n + incx - 1) / incx;
+		size_t ny = (n + incy - 1) / incy;
+		return kulisch_dot(std::min(nx, ny), x, incx, y, incy);
+	}
+	else if constexpr (is_complex_posit_v<typename Vector::value_type>) {
+		using Real = typename Vector::value_type::value_type;
+		complex_quire<Real::nbits, Real::es, capacity> q;
+		size_t ix, iy;
+		for (ix = 0, iy = 0; ix < n && iy < n; ix = ix + incx, iy = iy + incy) {
+			q.fma(x[ix], y[iy]);
+		}
+		typename Vector::value_type sum;
+		convert(q, sum);     // one and only rounding step of each component of the fused-dot product
+		return sum;
+	}
+	else {
+		constexpr size_t nbits = Vector::value_type::nbits;
+		constexpr size_t es = Vector::value_type::es;
+		fused_quire_t<nbits, es, capacity> q(0);
+		if constexpr (is_contiguous_vector_v<Vector>) {
+			if (!sw::universal::_trace_quire_add) {
+				fdp_qr(q, n, x, incx, y, incy);
+				typename Vector::value_type sum;
+				sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
+				return sum;
+			}
+		}
+		size_t ix, iy;
+		for (ix = 0, iy = 0; ix < n && iy < n; ix = ix + incx, iy = iy + incy) {
+			quire_fma(q, x[ix], y[iy]);
+			if (sw::universal::_trace_quire_add) std::cout << q << '\n';
+		}
+		typename Vector::value_type sum;
+		sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
+		return sum;
 	}
-	typename Vector::value_type sum;
-	sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
-	return sum;
 }
 // Specialized resolved fused dot product that assumes unit stride and a standard vector,
 // with the option to control capacity bits in the quire
 template<typename Vector, size_t capacity = 10>
 typename Vector::value_type fdp(const Vector& x, const Vector& y) {
 	using namespace mtl;
-	constexpr size_t nbits = Vector::value_type::nbits;
-	constexpr size_t es = Vector::value_type::es;
-	sw::universal::quire<nbits, es, capacity> q(0);
-	size_t ix, iy, n = mtl::size(x);
-	for (ix = 0, iy = 0; ix < n && iy < n; ++ix, ++iy) {
-		q += sw::universal::quire_mul(x[ix], y[iy]);
+	if constexpr (is_ieee_binary_v<typename Vector::value_type>) {
+		return kulisch_dot(mtl::size(x), x, 1, y, 1);
+	}
+	else if constexpr (is_complex_posit_v<typename Vector::value_type>) {
+		return fdp_stride<Vector, capacity>(mtl::size(x), x, 1, y, 1);
+	}
+	else {
+		constexpr size_t nbits = Vector::value_type::nbits;
+		constexpr size_t es = Vector::value_type::es;
+		fused_quire_t<nbits, es, capacity> q(0);
+		size_t ix, iy, n = mtl::size(x);
+		for (ix = 0, iy = 0; ix < n && iy < n; ++ix, ++iy) {
+			quire_fma(q, x[ix], y[iy]);
+		}
+		typename Vector::value_type sum;
+		sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
+		return sum;
+	}
+}
+
+// Conjugated fused dot product of complex posit vectors, sum of conj(x[i]) * y[i], rounded once per component
+template<typename Vector, size_t capacity = 10>
+typename Vector::value_type fdpc(const Vector& x, const Vector& y) {
+	static_assert(is_complex_posit_v<typename Vector::value_type>, "fdpc requires vectors of complex posits");
+	using Real = typename Vector::value_type::value_type;
+	complex_quire<Real::nbits, Real::es, capacity> q;
+	size_t n = mtl::size(x);
+	for (size_t i = 0; i < n; ++i) {
+		q.fma_conj(x[i], y[i]);
 	}
 	typename Vector::value_type sum;
+	convert(q, sum);     // one and only rounding step of each component of the fused-dot product
+	return sum;
+}
+
+///
+/// mixed-configuration fused dot products
+/// x and y hold posits of two different configurations, for example posit<8,0> weights and posit<16,1>
+/// activations. The exact products accumulate in a quire of an explicitly chosen configuration, which
+/// is also the configuration of the result. The operands are decoded in place, so neither vector is converted.
+
+// Resolved fused dot product of two posit configurations, same index semantics as fdp_stride
+template<size_t qnbits, size_t qes, size_t qcapacity = 30, typename VectorX, typename VectorY>
+sw::universal::posit<qnbits, qes> fdp_stride(size_t n, const VectorX& x, size_t incx, const VectorY& y, size_t incy) {
+	static_assert(is_posit_v<typename VectorX::value_type> && is_posit_v<typename VectorY::value_type>, "mixed-configuration fdp requires posit vectors");
+	mixed_quire<qnbits, qes, qcapacity> q;
+	size_t ix, iy;
+	for (ix = 0, iy = 0; ix < n && iy < n; ix = ix + incx, iy = iy + incy) {
+		q.fma(x[ix], y[iy]);
+	}
+	sw::universal::posit<qnbits, qes> sum;
 	sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
 	return sum;
 }
+// Resolved fused dot product of two posit configurations over the common length of x and y
+template<size_t qnbits, size_t qes, size_t qcapacity = 30, typename VectorX, typename VectorY>
+sw::universal::posit<qnbits, qes> fdp(const VectorX& x, const VectorY& y) {
+	size_t n = std::min(size_t(mtl::size(x)), size_t(mtl::size(y)));
+	return fdp_stride<qnbits, qes, qcapacity>(n, x, 1, y, 1);
+}
+
+///
+/// parallel fused dot product operators
+/// The index range is split into contiguous blocks, each block accumulates into its own quire,
+/// and the partial quires are merged exactly before the single rounding step.
+/// The result is bitwise identical to the sequential fdp for any thread count.
+
+// minimum number of products a worker accumulates before it is worth splitting the range
+constexpr size_t HPRBLAS_FDP_PARALLEL_GRAIN = 4096;
+
+// Parallel resolved fused dot product with stride, same index semantics as fdp_stride
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Vector, size_t capacity = 10>
+typename Vector::value_type fdp_stride_parallel(size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy, size_t nrThreads = 0) {
+	// number of products: the index loop of fdp_stride stops when either index reaches n
+	size_t nx = (n + incx - 1) / incx;
+	size_t ny = (n + incy - 1) / incy;
+	size_t nrProducts = (nx < ny ? nx : ny);
+	if constexpr (is_ieee_binary_v<typename Vector::value_type>) {
+		return kulisch_dot(nrProducts, x, incx, y, incy, nrThreads);
+	}
+	else if constexpr (is_complex_posit_v<typename Vector::value_type>) {
+		using Real = typename Vector::value_type::value_type;
+		auto q = reproducible_dot< complex_quire<Real::nbits, Real::es, capacity> >(nrProducts, x, incx, y, incy, nrThreads);
+		typename Vector::value_type sum;
+		convert(q, sum);     // one and only rounding step of each component of the fused-dot product
+		return sum;
+	}
+	else {
+		constexpr size_t nbits = Vector::value_type::nbits;
+		constexpr size_t es = Vector::value_type::es;
+		using Quire = fused_quire_t<nbits, es, capacity>;
+		size_t nrBlocks = nr_of_blocks(nrProducts, nrThreads, HPRBLAS_FDP_PARALLEL_GRAIN);
+		std::vector<Quire> partial(nrBlocks);
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+			size_t first, last;
+			block_range(nrProducts, nrBlocks, b, first, last);
+			Quire q(0);
+			if constexpr (is_contiguous_vector_v<Vector>) {
+				if (last > first) fdp_qr(q, last - first, &x[first * incx], incx, &y[first * incy], incy);
+			}
+			else {
+				for (size_t k = first; k < last; ++k) {
+					quire_fma(q, x[k * incx], y[k * incy]);
+				}
+			}
+			partial[b] = q;
+		});
+		Quire q(0);
+		for (size_t b = 0; b < nrBlocks; ++b) q += partial[b];   // exact merge
+		typename Vector::value_type sum;
+		sw::universal::convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
+		return sum;
+	}
+}
+// Parallel resolved fused dot product that assumes unit stride and a standard vector
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Vector, size_t capacity = 10>
+typename Vector::value_type fdp_parallel(const Vector& x, const Vector& y, size_t nrThreads = 0) {
+	return fdp_stride_parallel<Vector, capacity>(mtl::size(x), x, 1, y, 1, nrThreads);
+}
+
+///
+/// capacity-aware fused dot products
+/// The capacity of the quire is derived from the number of products, so short dot products accumulate
+/// in fewer limbs and long ones cannot overflow. fdp_sized fixes the capacity at compile time from an
+/// upper bound on the length, fdp_auto dispatches at runtime over a few capacity tiers. Both throw a
+/// quire_capacity_exception when the length exceeds the capacity available.
+
+// capacity tiers of the runtime dispatch; the largest covers any vector with a 32-bit index
+constexpr size_t HPRBLAS_QUIRE_CAPACITY_TIERS[] = { 8, 16, 24, 32 };
+
+// fused dot product of at most maxProducts products, in a quire sized for maxProducts
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t maxProducts, typename Vector>
+typename Vector::value_type fdp_sized(const Vector& x, const Vector& y, size_t nrThreads = 0) {
+	constexpr size_t capacity = quire_capacity_for(maxProducts);
+	// preconditions
+	assert(mtl::size(x) == mtl::size(y));
+	size_t nrProducts = std::min(size_t(mtl::size(x)), size_t(mtl::size(y)));
+	if (nrProducts > maxProducts) throw quire_capacity_exception(nrProducts, capacity);
+	return fdp_stride_parallel<Vector, capacity>(nrProducts, x, 1, y, 1, nrThreads);
+}
+
+// fused dot product with stride, same index semantics as fdp_stride, in the smallest capacity tier that holds the products
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Vector>
+typename Vector::value_type fdp_stride_auto(size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy, size_t nrThreads = 0) {
+	size_t nx = (n + incx - 1) / incx;
+	size_t ny = (n + incy - 1) / incy;
+	size_t capacity = quire_capacity_for(nx < ny ? nx : ny);
+	constexpr const size_t* tier = HPRBLAS_QUIRE_CAPACITY_TIERS;
+	if (capacity <= tier[0]) return fdp_stride_parallel<Vector, tier[0]>(n, x, incx, y, incy, nrThreads);
+	if (capacity <= tier[1]) return fdp_stride_parallel<Vector, tier[1]>(n, x, incx, y, incy, nrThreads);
+	if (capacity <= tier[2]) return fdp_stride_parallel<Vector, tier[2]>(n, x, incx, y, incy, nrThreads);
+	if (capacity <= tier[3]) return fdp_stride_parallel<Vector, tier[3]>(n, x, incx, y, incy, nrThreads);
+	throw quire_capacity_exception(nx < ny ? nx : ny, tier[3]);
+}
+// unit stride fused dot product in the smallest capacity tier that holds the products
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Vector>
+typename Vector::value_type fdp_auto(const Vector& x, const Vector& y, size_t nrThreads = 0) {
+	return fdp_stride_auto(size_t(mtl::size(x)), x, 1, y, 1, nrThreads);
+}
+
+///
+/// batched fused dot product operators
+/// Many short dot products are dominated by per-call setup. The batched operators set up one quire
+/// per worker, reset it between dot products, and walk the operands through raw pointers.
+
+// Batched fused dot product: result[i] = fdp(X[i], Y[i]) for all pairs in the batch
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Vector, size_t capacity = 10>
+void fdp_batch(Vector& result, const std::vector<Vector>& X, const std::vector<Vector>& Y, size_t nrThreads = 0) {
+	static_assert(is_contiguous_vector_v<Vector> && is_posit_v<typename Vector::value_type>, "batched fused dot products require contiguous vectors of posits");
+	constexpr size_t nbits = Vector::value_type::nbits;
+	constexpr size_t es = Vector::value_type::es;
+	using Quire = fused_quire_t<nbits, es, capacity>;
+	// preconditions
+	assert(X.size() == Y.size());
+	assert(mtl::size(result) == X.size());
+	size_t nrPairs = X.size();
+	if (nrPairs == 0) return;
+	size_t nrProducts = 0;
+	for (size_t i = 0; i < nrPairs; ++i) nrProducts += mtl::size(X[i]);
+	size_t avgLength = nrProducts / nrPairs + 1;
+	size_t nrBlocks = nr_of_blocks(nrPairs, nrThreads, HPRBLAS_FDP_PARALLEL_GRAIN / avgLength + 1);
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+		size_t first, last;
+		block_range(nrPairs, nrBlocks, b, first, last);
+		Quire q;
+		for (size_t i = first; i < last; ++i) {
+			size_t n = mtl::size(X[i]);
+			assert(mtl::size(Y[i]) == n);
+			q.reset();
+			if (n > 0) fdp_qr(q, n, &X[i][0], &Y[i][0]);
+			sw::universal::convert(q.to_value(), result[i]);     // one and only rounding step of each fused-dot product
+		}
+	});
+}
+
+// Batched fused dot product over the rows of two matrices: result[i] = fdp(A[i][:], B[i][:])
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es, size_t capacity = 10>
+void fdp_batch(mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& result, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& B, size_t nrThreads = 0) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Quire = fused_quire_t<nbits, es, capacity>;
+	// preconditions
+	assert(A.num_rows() == B.num_rows());
+	assert(A.num_cols() == B.num_cols());
+	assert(mtl::size(result) == A.num_rows());
+	size_t nrPairs = A.num_rows();
+	size_t n = A.num_cols();
+	if (nrPairs == 0) return;
+	const Scalar* a = A.address_data();   // row-major storage: row i starts at i * n
+	const Scalar* bb = B.address_data();
+	size_t nrBlocks = nr_of_blocks(nrPairs, nrThreads, HPRBLAS_FDP_PARALLEL_GRAIN / (n + 1) + 1);
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t b) {
+		size_t first, last;
+		block_range(nrPairs, nrBlocks, b, first, last);
+		Quire q;
+		for (size_t i = first; i < last; ++i) {
+			q.reset();
+			fdp_qr(q, n, a + i * n, bb + i * n);
+			sw::universal::convert(q.to_value(), result[i]);     // one and only rounding step of each fused-dot product
+		}
+	});
+}
+
+///
+/// fused vector updates
+/// Each output element is the exact sum a*x[i] + b*y[i], accumulated in a quire and rounded once.
+/// Elements are independent, so the index range is split into blocks over the thread pool. Posits that
+/// fit a 32-bit lane are decoded a chunk at a time into posit panels by the SIMD batch decoder.
+
+// minimum number of elements a worker updates before it is worth splitting the range
+constexpr size_t HPRBLAS_FUSED_UPDATE_PARALLEL_GRAIN = 4096;
+// number of elements decoded into a panel at a time
+constexpr size_t HPRBLAS_FUSED_UPDATE_CHUNK = 256;
+
+// w[k*incw] = a*x[k*incx] + b*y[k*incy] for k in [0, m), one rounding per element
+// w may be y with incw == incy: every element is read before it is written
+template<typename Vector>
+void fused_waxpby_elements(size_t m, const typename Vector::value_type& a, const Vector& x, size_t incx, const typename Vector::value_type& b, const Vector& y, size_t incy, Vector& w, size_t incw, size_t nrThreads) {
+	using Scalar = typename Vector::value_type;
+	static_assert(is_posit_v<Scalar>, "fused vector updates require posit elements");
+	constexpr size_t nbits = Scalar::nbits;
+	constexpr size_t es = Scalar::es;
+	if (m == 0) return;
+	size_t nrBlocks = nr_of_blocks(m, nrThreads, HPRBLAS_FUSED_UPDATE_PARALLEL_GRAIN);
+	if constexpr (use_decoded_panels<nbits, es> && is_contiguous_vector_v<Vector>) {
+		decoded_posit da = decode_posit(a);
+		decoded_posit db = decode_posit(b);
+		unsigned flagsA = (da.sign ? 1 : 0) | (da.nar ? 2 : 0);
+		unsigned flagsB = (db.sign ? 1 : 0) | (db.nar ? 2 : 0);
+		const Scalar* px = &x[0];
+		const Scalar* py = &y[0];
+		Scalar* pw = &w[0];
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+			size_t first, last;
+			block_range(m, nrBlocks, blk, first, last);
+			posit_panel<nbits, es> xp(HPRBLAS_FUSED_UPDATE_CHUNK), yp(HPRBLAS_FUSED_UPDATE_CHUNK);
+			panel_quire_t<nbits, es> q;
+			for (size_t k = first; k < last; k += HPRBLAS_FUSED_UPDATE_CHUNK) {
+				size_t len = std::min(HPRBLAS_FUSED_UPDATE_CHUNK, last - k);
+				xp.decode(0, len, px + k * incx, incx);
+				yp.decode(0, len, py + k * incy, incy);
+				for (size_t i = 0; i < len; ++i) {
+					q.reset();
+					q.fma_decoded(da.significand, da.scale, flagsA, xp.significand()[i], xp.scale()[i], xp.flags()[i]);
+					q.fma_decoded(db.significand, db.scale, flagsB, yp.significand()[i], yp.scale()[i], yp.flags()[i]);
+					sw::universal::convert(q.to_value(), pw[(k + i) * incw]);     // one and only rounding step of the update
+				}
+			}
+		});
+	}
+	else {
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+			size_t first, last;
+			block_range(m, nrBlocks, blk, first, last);
+			fused_quire_t<nbits, es> q;
+			for (size_t k = first; k < last; ++k) {
+				q.reset();
+				quire_fma(q, a, x[k * incx]);
+				quire_fma(q, b, y[k * incy]);
+				sw::universal::convert(q.to_value(), w[k * incw]);     // one and only rounding step of the update
+			}
+		});
+	}
+}
+
+// fused a times x plus y: y = a*x + y with one rounding per element
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Scalar, typename Vector>
+void faxpy(size_t n, const Scalar& a, const Vector& x, size_t incx, Vector& y, size_t incy, size_t nrThreads = 0) {
+	using Element = typename Vector::value_type;
+	size_t m = std::min(strided_count(n, x, incx), strided_count(n, y, incy));
+	fused_waxpby_elements(m, Element(a), x, incx, Element(1), y, incy, y, incy, nrThreads);
+}
+
+// fused a times x plus b times y: y = a*x + b*y with one rounding per element
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Scalar, typename Vector>
+void faxpby(size_t n, const Scalar& a, const Vector& x, size_t incx, const Scalar& b, Vector& y, size_t incy, size_t nrThreads = 0) {
+	using Element = typename Vector::value_type;
+	size_t m = std::min(strided_count(n, x, incx), strided_count(n, y, incy));
+	fused_waxpby_elements(m, Element(a), x, incx, Element(b), y, incy, y, incy, nrThreads);
+}
+
+// fused w = a*x + b*y with one rounding per element
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Scalar, typename Vector>
+void fwaxpby(size_t n, const Scalar& a, const Vector& x, size_t incx, const Scalar& b, const Vector& y, size_t incy, Vector& w, size_t incw, size_t nrThreads = 0) {
+	using Element = typename Vector::value_type;
+	size_t m = std::min(std::min(strided_count(n, x, incx), strided_count(n, y, incy)), strided_count(n, w, incw));
+	fused_waxpby_elements(m, Element(a), x, incx, Element(b), y, incy, w, incw, nrThreads);
+}
+
+// rotate the pair (x, y) to (c*x + s*y, c*y - s*x), one rounding per component
+template<typename Quire, typename Scalar>
+inline void fused_rotate(Quire& q, const Scalar& c, const Scalar& s, Scalar& x, Scalar& y) {
+	Scalar xr, yr;
+	q.reset();
+	quire_fma(q, c, x);
+	quire_fma(q, s, y);
+	sw::universal::convert(q.to_value(), xr);     // one and only rounding step of the rotated x
+	q.reset();
+	quire_fma(q, c, y);
+	quire_fma(q, -s, x);
+	sw::universal::convert(q.to_value(), yr);     // one and only rounding step of the rotated y
+	x = xr;
+	y = yr;
+}
+
+// fused rotation of points in the plane: x_i = c*x_i + s*y_i and y_i = c*y_i - s*x_i with one rounding per element
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Scalar, typename Vector>
+void frot(size_t n, Vector& x, size_t incx, Vector& y, size_t incy, const Scalar& c, const Scalar& s, size_t nrThreads = 0) {
+	using Element = typename Vector::value_type;
+	static_assert(is_posit_v<Element>, "fused rotations require posit elements");
+	size_t m = std::min(strided_count(n, x, incx), strided_count(n, y, incy));
+	if (m == 0) return;
+	Element ce(c), se(s);
+	size_t nrBlocks = nr_of_blocks(m, nrThreads, HPRBLAS_FUSED_UPDATE_PARALLEL_GRAIN);
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+		size_t first, last;
+		block_range(m, nrBlocks, blk, first, last);
+		fused_quire_t<Element::nbits, Element::es> q;
+		for (size_t k = first; k < last; ++k) {
+			Element xk = x[k * incx], yk = y[k * incy];
+			fused_rotate(q, ce, se, xk, yk);
+			x[k * incx] = xk;
+			y[k * incy] = yk;
+		}
+	});
+}
+
+// fused batched rotation: applies the rotations (c[k], s[k]), k in [0, nr - 1), in order to the adjacent
+// rows k and k + 1 of the row-major matrix A, each rotation rounding once per element.
+// The columns are swept in chunks that stay in cache while the whole sequence of rotations is applied;
+// columns are independent, so the chunks are split over the thread pool.
+template<size_t nbits, size_t es>
+void frot_batch(mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const std::vector< sw::universal::posit<nbits, es> >& c, const std::vector< sw::universal::posit<nbits, es> >& s, size_t nrThreads = 0) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	size_t nr = A.num_rows();
+	size_t nc = A.num_cols();
+	if (nr < 2 || nc == 0) return;
+	size_t nrRotations = std::min(nr - 1, std::min(c.size(), s.size()));
+	if (nrRotations == 0) return;
+	Scalar* a = A.address_data();
+	size_t nrChunks = (nc + HPRBLAS_FUSED_UPDATE_CHUNK - 1) / HPRBLAS_FUSED_UPDATE_CHUNK;
+	size_t nrBlocks = nr_of_blocks(nrChunks, nrThreads, std::max<size_t>(1, HPRBLAS_FUSED_UPDATE_PARALLEL_GRAIN / (HPRBLAS_FUSED_UPDATE_CHUNK * nrRotations)));
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+		size_t firstChunk, lastChunk;
+		block_range(nrChunks, nrBlocks, blk, firstChunk, lastChunk);
+		fused_quire_t<nbits, es> q;
+		for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk) {
+			size_t first = chunk * HPRBLAS_FUSED_UPDATE_CHUNK;
+			size_t last = std::min(nc, first + HPRBLAS_FUSED_UPDATE_CHUNK);
+			for (size_t k = 0; k < nrRotations; ++k) {
+				Scalar* x = a + k * nc;
+				Scalar* y = x + nc;
+				for (size_t j = first; j < last; ++j) fused_rotate(q, c[k], s[k], x[j], y[j]);
+			}
+		}
+	});
+}
 
 // rotation of points in the plane
 template<typename Rotation, typename Vector>
@@ -131,6 +893,13 @@ void rot(size_t n, Vector& x, size_t incx, Vector& y, size_t incy, Rotation c, R
 	using namespace mtl;
 	// x_i = c*x_i + s*y_i
 	// y_i = c*y_i - s*x_i
+	if constexpr (is_contiguous_vector_v<Vector>) {
+		if (incx == 1 && incy == 1) {
+			size_t cnt = unit_stride_count(n, x, y);
+			if (cnt > 0) contiguous_rot(cnt, &x[0], &y[0], c, s);
+			return;
+		}
+	}
 	size_t cnt, ix, iy;
 	for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < size(x) && iy < size(y); ++cnt, ix += incx, iy += incy) {
 		Rotation x_i = c*x[ix] + s*y[iy];
@@ -140,18 +909,182 @@ void rot(size_t n, Vector& x, size_t incx, Vector& y, size_t incy, Rotation c, R
 	}
 }
 
+// sqrt(a*a + b*b): posits accumulate the squares in a quire and round once before the square root,
+// IEEE values scale by |a| + |b| to avoid overflow and underflow of the squares
+template<typename T>
+T hypotenuse(const T& a, const T& b) {
+	using std::sqrt;
+	if constexpr (is_posit_v<T>) {
+		fused_quire_t<T::nbits, T::es> q;
+		quire_fma(q, a, a);
+		quire_fma(q, b, b);
+		T sumsq;
+		sw::universal::convert(q.to_value(), sumsq);     // first rounding step of the hypotenuse
+		return sqrt(sumsq);                              // second rounding step of the hypotenuse
+	}
+	else {
+		T scale = (a < 0 ? -a : a) + (b < 0 ? -b : b);
+		if (scale == T(0)) return T(0);
+		T as = a / scale, bs = b / scale;
+		return scale * sqrt(as * as + bs * bs);
+	}
+}
+
 // compute parameters for a Givens rotation
+// Given Cartesian coordinates (a,b) of a point, return the parameters c and s of the rotation that zeroes b,
+// with r in a and the reconstruction parameter z in b, following the reference BLAS rotg
 template<typename T>
 void rotg(T& a, T& b, T& c, T&s) {
-	// Given Cartesian coordinates (a,b) of a point, return parameters c,s,r, and z associated with the Givens rotation.
+	T absA = (a < 0 ? -a : a);
+	T absB = (b < 0 ? -b : b);
+	T roe = (absA > absB ? a : b);
+	if (absA + absB == T(0)) {
+		c = T(1);
+		s = T(0);
+		a = T(0);
+		b = T(0);
+		return;
+	}
+	T r = hypotenuse(a, b);
+	if (roe < 0) r = -r;
+	c = a / r;
+	s = b / r;
+	T z = T(1);
+	if (absA > absB) z = s;
+	if (absB >= absA && c != T(0)) z = T(1) / c;
+	a = r;
+	b = z;
+}
+
+// compute parameters for a modified Givens rotation
+// Given the scale factors d1 and d2 and the point (x1, y1), return the matrix H in param, following
+// the reference BLAS rotmg: param[0] is the flag, param[1..4] are h11, h21, h12 and h22.
+// Posits cannot underflow, so the rescaling of d1 and d2 by powers of gam is only done for IEEE values.
+template<typename T>
+void rotmg(T& d1, T& d2, T& x1, const T& y1, T param[5]) {
+	const T gam = T(4096), gamsq = gam * gam, rgamsq = T(1) / gamsq;
+	T flag, h11 = T(0), h12 = T(0), h21 = T(0), h22 = T(0);
+	auto magnitude = [](const T& v) { return (v < 0 ? -v : v); };
+	if (d1 < 0) {
+		flag = T(-1);
+		d1 = T(0);
+		d2 = T(0);
+		x1 = T(0);
+	}
+	else {
+		T p2 = d2 * y1;
+		if (p2 == T(0)) {
+			param[0] = T(-2);
+			return;
+		}
+		T p1 = d1 * x1;
+		T q2 = p2 * y1;
+		T q1 = p1 * x1;
+		if (magnitude(q1) > magnitude(q2)) {
+			h21 = -y1 / x1;
+			h12 = p2 / p1;
+			T u = T(1) - h12 * h21;
+			if (u > 0) {
+				flag = T(0);
+				d1 /= u;
+				d2 /= u;
+				x1 *= u;
+			}
+			else {
+				flag = T(-1);
+				h11 = h12 = h21 = h22 = T(0);
+				d1 = T(0);
+				d2 = T(0);
+				x1 = T(0);
+			}
+		}
+		else if (q2 < 0) {
+			flag = T(-1);
+			h11 = h12 = h21 = h22 = T(0);
+			d1 = T(0);
+			d2 = T(0);
+			x1 = T(0);
+		}
+		else {
+			flag = T(1);
+			h11 = p1 / p2;
+			h22 = x1 / y1;
+			T u = T(1) + h11 * h22;
+			T temp = d2 / u;
+			d2 = d1 / u;
+			d1 = temp;
+			x1 = y1 * u;
+		}
+		if constexpr (!is_posit_v<T>) {
+			auto full = [&]() {
+				if (flag == T(0)) { h11 = T(1); h22 = T(1); }
+				else { h21 = T(-1); h12 = T(1); }
+				flag = T(-1);
+			};
+			if (d1 != T(0)) {
+				while (d1 <= rgamsq || d1 >= gamsq) {
+					full();
+					if (d1 <= rgamsq) { d1 *= gamsq; x1 /= gam; h11 /= gam; h12 /= gam; }
+					else { d1 /= gamsq; x1 *= gam; h11 *= gam; h12 *= gam; }
+				}
+			}
+			if (d2 != T(0)) {
+				while (magnitude(d2) <= rgamsq || magnitude(d2) >= gamsq) {
+					full();
+					if (magnitude(d2) <= rgamsq) { d2 *= gamsq; h21 /= gam; h22 /= gam; }
+					else { d2 /= gamsq; h21 *= gam; h22 *= gam; }
+				}
+			}
+		}
+	}
+	if (flag < 0) {
+		param[1] = h11;
+		param[2] = h21;
+		param[3] = h12;
+		param[4] = h22;
+	}
+	else if (flag == T(0)) {
+		param[2] = h21;
+		param[3] = h12;
+	}
+	else {
+		param[1] = h11;
+		param[4] = h22;
+	}
+	param[0] = flag;
+}
+
+// apply the modified Givens rotation H of rotmg to the points (x_i, y_i)
+template<typename Vector>
+void rotm(size_t n, Vector& x, size_t incx, Vector& y, size_t incy, const typename Vector::value_type param[5]) {
+	using T = typename Vector::value_type;
+	T flag = param[0];
+	if (flag == T(-2)) return;
+	T h11 = (flag == T(0) ? T(1) : param[1]);
+	T h21 = (flag == T(1) ? T(-1) : param[2]);
+	T h12 = (flag == T(1) ? T(1) : param[3]);
+	T h22 = (flag == T(0) ? T(1) : param[4]);
+	size_t cnt, ix, iy;
+	for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < mtl::size(x) && iy < mtl::size(y); ++cnt, ix += incx, iy += incy) {
+		T w = x[ix], z = y[iy];
+		x[ix] = w * h11 + z * h12;
+		y[iy] = w * h21 + z * h22;
+	}
 }
 
 // scale a vector
 template<typename Scalar, typename Vector>
 void scale(size_t n, Scalar a, Vector& x, size_t incx) {
 	using namespace mtl;
+	if constexpr (is_contiguous_vector_v<Vector>) {
+		if (incx == 1) {
+			size_t cnt = std::min(n, size_t(size(x)));
+			if (cnt > 0) contiguous_scale(cnt, a, &x[0]);
+			return;
+		}
+	}
 	size_t cnt, ix;
-	for (cnt = 0, ix = 0; cnt < n && ix < size(x); ix += incx) {
+	for (cnt = 0, ix = 0; cnt < n && ix < size(x); ++cnt, ix += incx) {
 		x[ix] *= a;
 	}
 }
@@ -160,6 +1093,13 @@ void scale(size_t n, Scalar a, Vector& x, size_t incx) {
 template<typename Vector>
 void swap(size_t n, Vector& x, size_t incx, Vector& y, size_t incy) {
 	using namespace mtl;
+	if constexpr (is_contiguous_vector_v<Vector>) {
+		if (incx == 1 && incy == 1) {
+			size_t cnt = unit_stride_count(n, x, y);
+			if (cnt > 0) contiguous_swap(cnt, &x[0], &y[0]);
+			return;
+		}
+	}
 	size_t cnt, ix, iy;
 	for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < size(x) && iy < size(y); ++cnt, ix += incx, iy += incy) {
 		typename Vector::value_type tmp = x[ix];
@@ -168,39 +1108,24 @@ void swap(size_t n, Vector& x, size_t incx, Vector& y, size_t incy) {
 	}
 }
 
-// find the index of the element with maximum absolute value
+// find the index of the first element with maximum absolute value among the n elements
+// x[0], x[incx], ..., x[(n-1)*incx]: returns the element number k of x[k*incx], 0 when n is 0
 template<typename Vector>
-size_t amax(size_t n, const Vector& x, size_t incx) {
-	using namespace mtl;
-	typename Vector::value_type running_max = -INFINITY;
-	size_t ix, index;
-	for (ix = 0; ix < size(x); ix += incx) {
-		if (x[ix] > running_max) {
-			index = ix;
-			running_max = x[ix];
-		}
-	}
-	return index;
+size_t amax(size_t n, const Vector& x, size_t incx = 1) {
+	return magnitude_search<true>(strided_count(n, x, incx), x, incx);
 }
 
-// find the index of the element with minimum absolute value
+// find the index of the first element with minimum absolute value among the n elements
+// x[0], x[incx], ..., x[(n-1)*incx]: returns the element number k of x[k*incx], 0 when n is 0
 template<typename Vector>
-size_t amin(size_t n, const Vector& x, size_t incx) {
-	using namespace mtl;
-	typename Vector::value_type running_min = INFINITY;
-	size_t ix, index;
-	for (ix = 0; ix < size(x); ix += incx) {
-		if (x[ix] < running_min) {
-			index = ix;
-			running_min = x[ix];
-		}
-	}
-	return index;
+size_t amin(size_t n, const Vector& x, size_t incx = 1) {
+	return magnitude_search<false>(strided_count(n, x, incx), x, incx);
 }
 
 // absolute value of a complex number
-template<typename T>
-T cabs(T z) {
+template<typename Real>
+Real cabs(const std::complex<Real>& z) {
+	return hypotenuse(z.real(), z.imag());
 }
 
 // print a vector
@@ -223,26 +1148,74 @@ void matvec(Vector& b, const Matrix& A, const Vector& x) {
 	b = A * x;
 }
 
+///
+/// row-partitioned matrix-vector products
+/// Every element of b is an independent fused-dot product of a row of A with x, so the rows are split
+/// into blocks over the thread pool and b is bitwise identical for every thread count. Blocks are
+/// made of whole cache lines of b, so that no two workers write into the same line of the output.
+
+// number of bytes in a cache line of the output vector
+constexpr size_t HPRBLAS_CACHE_LINE = 64;
+// minimum number of products a worker computes before it is worth splitting the rows
+constexpr size_t HPRBLAS_MATVEC_PARALLEL_GRAIN = 32768;
+
+// calls kernel(first, last) on row blocks [first, last) of nr rows of length nc, on the thread pool
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Scalar, typename RowKernel>
+void parallel_rows(size_t nr, size_t nc, size_t nrThreads, RowKernel&& kernel) {
+	if (nr == 0) return;
+	constexpr size_t rowsPerLine = std::max<size_t>(1, HPRBLAS_CACHE_LINE / sizeof(Scalar));
+	size_t nrLines = (nr + rowsPerLine - 1) / rowsPerLine;
+	size_t grain = std::max<size_t>(1, HPRBLAS_MATVEC_PARALLEL_GRAIN / (rowsPerLine * std::max<size_t>(1, nc)));
+	size_t nrBlocks = nr_of_blocks(nrLines, nrThreads, grain);
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+		size_t firstLine, lastLine;
+		block_range(nrLines, nrBlocks, blk, firstLine, lastLine);
+		size_t first = firstLine * rowsPerLine;
+		size_t last = std::min(nr, lastLine * rowsPerLine);
+		if (first < last) kernel(first, last);
+	});
+}
+
+// Fused matrix-vector product b = A * x over row-major arrays:
+// x is decoded once into a panel shared by all workers, and each row of A once into the row panel of its worker
+template<size_t nbits, size_t es, size_t capacity = 30>
+void panel_matvec(size_t nr, size_t nc, const sw::universal::posit<nbits, es>* A, const sw::universal::posit<nbits, es>* x, sw::universal::posit<nbits, es>* b, size_t nrThreads = 0) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	posit_panel<nbits, es> xp(nc, x);
+	parallel_rows<Scalar>(nr, nc, nrThreads, [&](size_t first, size_t last) {
+		posit_panel<nbits, es> row(nc);
+		panel_quire_t<nbits, es, capacity> q;
+		for (size_t i = first; i < last; ++i) {
+			row.decode(0, nc, A + i * nc);
+			q.reset();
+			fdp_qr(q, nc, row, 0, xp, 0);
+			sw::universal::convert(q.to_value(), b[i]);     // one and only rounding step of the fused-dot product
+		}
+	});
+}
+
 // Matrix-vector product: b = A * x, posit specialized
+// nrThreads = 0 selects the size of the default thread pool
 template<size_t nbits, size_t es>
-void matvec(mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& b, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x) {
+void matvec(mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& b, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
 	using namespace mtl;
+	using Scalar = sw::universal::posit<nbits, es>;
 	// preconditions
 	assert(A.num_cols() == size(x));
-	assert(size(b) == size(x));
+	assert(A.num_rows() == size(b));
 
-#if HPRBLAS_TRACE_ROUNDING_EVENTS
-	unsigned errors = 0;
-#endif
 	size_t nr = size(b);
 	size_t nc = size(x);
+#if HPRBLAS_TRACE_ROUNDING_EVENTS
+	// tracing reports the rounding events in row order, so it runs on the calling thread
+	unsigned errors = 0;
 	for (size_t i = 0; i < nr; ++i) {
-		sw::universal::quire<nbits, es> q(0);
+		fused_quire_t<nbits, es> q(0);
 		for (size_t j = 0; j < nc; ++j) {
-			q += sw::universal::quire_mul(A[i][j], x[j]);
+			quire_fma(q, A[i][j], x[j]);
 		}
 		sw::universal::convert(q.to_value(), b[i]);     // one and only rounding step of the fused-dot product
-#if HPRBLAS_TRACE_ROUNDING_EVENTS
 		sw::universal::quire<nbits, es> qdiff = q;
 		sw::universal::quire<nbits, es> qsum = b[i];
 		qdiff -= qsum;
@@ -255,54 +1228,491 @@ void matvec(mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& b, const
 			convert(qdiff.to_value(), roundingError);
 			std::cout << "matvec b[" << i << "] = " << posit_format(b[i]) << " rounding error: " << posit_format(roundingError) << " " << roundingError << std::endl;
 		}
-#endif
 	}
-#if HPRBLAS_TRACE_ROUNDING_EVENTS
 	if (errors) {
 		std::cout << "HPR-BLAS: tracing found " << errors << " rounding errors in matvec operation\n";
 	}
+#else
+	if (nr == 0) return;
+	if (nc == 0) {
+		for (size_t i = 0; i < nr; ++i) b[i] = Scalar(0);
+		return;
+	}
+	if constexpr (use_decoded_panels<nbits, es>) {
+		panel_matvec<nbits, es>(nr, nc, A.address_data(), &x[0], &b[0], nrThreads);
+	}
+	else {
+		const Scalar* a = A.address_data();
+		const Scalar* px = &x[0];
+		Scalar* pb = &b[0];
+		parallel_rows<Scalar>(nr, nc, nrThreads, [&](size_t first, size_t last) {
+			fused_quire_t<nbits, es> q;
+			for (size_t i = first; i < last; ++i) {
+				q.reset();
+				fdp_qr(q, nc, a + i * nc, px);
+				sw::universal::convert(q.to_value(), pb[i]);     // one and only rounding step of the fused-dot product
+			}
+		});
+	}
 #endif
 }
 
 // A times x = b fused matrix-vector product
+// nrThreads = 0 selects the size of the default thread pool
 template<size_t nbits, size_t es>
-mtl::vec::dense_vector< sw::universal::posit<nbits, es> > fmv(const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x) {
+mtl::vec::dense_vector< sw::universal::posit<nbits, es> > fmv(const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
 	using namespace mtl;
 	// preconditions
 	assert(A.num_cols() == size(x));
-	mtl::vec::dense_vector< sw::universal::posit<nbits, es> > b(size(x));
+	mtl::vec::dense_vector< sw::universal::posit<nbits, es> > b(A.num_rows());
+	matvec(b, A, x, nrThreads);
+	return b;
+}
+
+///
+/// transposed matrix-vector products
+/// b = A^T * x reads the columns of the row-major A. Instead of walking down the columns, a worker keeps
+/// one quire per output column of a tile of columns and streams the rows of A through the tile,
+/// so A is read once, in storage order, and each element of b still rounds once.
+
+// number of columns, and thus live quires, in the tile a worker streams the rows of A through
+constexpr size_t HPRBLAS_COLUMN_QUIRE_BLOCK = 256;
+
+// Fused transposed matrix-vector product b = A^T * x over the row-major nr x nc array A
+// the column tiles are independent, so they are split over the thread pool
+template<size_t nbits, size_t es, size_t capacity = 30>
+void column_quire_matvec(size_t nr, size_t nc, const sw::universal::posit<nbits, es>* A, const sw::universal::posit<nbits, es>* x, sw::universal::posit<nbits, es>* b, size_t nrThreads = 0) {
+	size_t nrTiles = (nc + HPRBLAS_COLUMN_QUIRE_BLOCK - 1) / HPRBLAS_COLUMN_QUIRE_BLOCK;
+	size_t grain = std::max<size_t>(1, HPRBLAS_MATVEC_PARALLEL_GRAIN / (HPRBLAS_COLUMN_QUIRE_BLOCK * std::max<size_t>(1, nr)));
+	size_t nrBlocks = nr_of_blocks(nrTiles, nrThreads, grain);
+	if constexpr (use_decoded_panels<nbits, es>) {
+		posit_panel<nbits, es> xp(nr, x);
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+			size_t firstTile, lastTile;
+			block_range(nrTiles, nrBlocks, blk, firstTile, lastTile);
+			posit_panel<nbits, es> row(HPRBLAS_COLUMN_QUIRE_BLOCK);
+			std::vector< panel_quire_t<nbits, es, capacity> > q(HPRBLAS_COLUMN_QUIRE_BLOCK);
+			for (size_t tile = firstTile; tile < lastTile; ++tile) {
+				size_t first = tile * HPRBLAS_COLUMN_QUIRE_BLOCK;
+				size_t len = std::min(HPRBLAS_COLUMN_QUIRE_BLOCK, nc - first);
+				for (size_t j = 0; j < len; ++j) q[j].reset();
+				for (size_t i = 0; i < nr; ++i) {
+					row.decode(0, len, A + i * nc + first);
+					uint32_t xs = xp.significand()[i];
+					int32_t  xe = xp.scale()[i];
+					uint8_t  xf = xp.flags()[i];
+					for (size_t j = 0; j < len; ++j) q[j].fma_decoded(row.significand()[j], row.scale()[j], row.flags()[j], xs, xe, xf);
+				}
+				for (size_t j = 0; j < len; ++j) sw::universal::convert(q[j].to_value(), b[first + j]);     // one and only rounding step of the fused-dot product
+			}
+		});
+	}
+	else {
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+			size_t firstTile, lastTile;
+			block_range(nrTiles, nrBlocks, blk, firstTile, lastTile);
+			std::vector< fused_quire_t<nbits, es, capacity> > q(HPRBLAS_COLUMN_QUIRE_BLOCK);
+			for (size_t tile = firstTile; tile < lastTile; ++tile) {
+				size_t first = tile * HPRBLAS_COLUMN_QUIRE_BLOCK;
+				size_t len = std::min(HPRBLAS_COLUMN_QUIRE_BLOCK, nc - first);
+				for (size_t j = 0; j < len; ++j) q[j].reset();
+				for (size_t i = 0; i < nr; ++i) {
+					const sw::universal::posit<nbits, es>* row = A + i * nc + first;
+					for (size_t j = 0; j < len; ++j) quire_fma(q[j], row[j], x[i]);
+				}
+				for (size_t j = 0; j < len; ++j) sw::universal::convert(q[j].to_value(), b[first + j]);     // one and only rounding step of the fused-dot product
+			}
+		});
+	}
+}
+
+// Transposed matrix-vector product: b = A^T * x, posit specialized
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+void matvec_trans(mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& b, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
+	using namespace mtl;
+	using Scalar = sw::universal::posit<nbits, es>;
+	// preconditions
+	assert(A.num_rows() == size(x));
+	assert(A.num_cols() == size(b));
+
+	size_t nr = size(x);
+	size_t nc = size(b);
+	if (nc == 0) return;
+	if (nr == 0) {
+		for (size_t j = 0; j < nc; ++j) b[j] = Scalar(0);
+		return;
+	}
+	column_quire_matvec<nbits, es>(nr, nc, A.address_data(), &x[0], &b[0], nrThreads);
+}
+
+// A^T times x = b fused transposed matrix-vector product
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+mtl::vec::dense_vector< sw::universal::posit<nbits, es> > fmv_trans(const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
+	using namespace mtl;
+	// preconditions
+	assert(A.num_rows() == size(x));
+	mtl::vec::dense_vector< sw::universal::posit<nbits, es> > b(A.num_cols());
+	matvec_trans(b, A, x, nrThreads);
+	return b;
+}
+
+///
+/// sparse matrix-vector products
+/// A row-major compressed2D stores the nonzeros of row i in [starts[i], starts[i+1]). Rows have very
+/// different lengths, so the rows are split into blocks with equal numbers of nonzeros instead of
+/// equal numbers of rows. Block boundaries are rounded to cache lines of b.
+
+// calls kernel(first, last) on row blocks [first, last) of a compressed matrix with nr rows and
+// row starts starts[0..nr], balanced by nonzero count, on the thread pool
+// nrThreads = 0 selects the size of the default thread pool
+template<typename Scalar, typename Index, typename RowKernel>
+void parallel_sparse_rows(size_t nr, const Index* starts, size_t nrThreads, RowKernel&& kernel) {
+	if (nr == 0) return;
+	constexpr size_t rowsPerLine = std::max<size_t>(1, HPRBLAS_CACHE_LINE / sizeof(Scalar));
+	size_t offset = size_t(starts[0]);
+	size_t nnz = size_t(starts[nr]) - offset;
+	// every row costs a quire reset and a rounding step on top of its products
+	size_t nrBlocks = nr_of_blocks(nnz + nr, nrThreads, HPRBLAS_MATVEC_PARALLEL_GRAIN);
+	auto boundary = [&](size_t blk) -> size_t {
+		if (blk == 0) return 0;
+		if (blk >= nrBlocks) return nr;
+		size_t target = offset + (nnz + nr) / nrBlocks * blk;
+		// first row i at which starts[i] + i reaches the target
+		size_t lo = 0, hi = nr;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (size_t(starts[mid]) + mid < target) lo = mid + 1; else hi = mid;
+		}
+		return std::min(nr, (lo + rowsPerLine / 2) / rowsPerLine * rowsPerLine);
+	};
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+		size_t first = boundary(blk);
+		size_t last = boundary(blk + 1);
+		if (first < last) kernel(first, last);
+	});
+}
+
+// Fused sparse matrix-vector product b = A * x over the compressed row arrays of A
+template<size_t nbits, size_t es, typename Index, size_t capacity = 30>
+void compressed_matvec(size_t nr, size_t nc, const Index* starts, const Index* indices, const sw::universal::posit<nbits, es>* values, const sw::universal::posit<nbits, es>* x, sw::universal::posit<nbits, es>* b, size_t nrThreads = 0) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	if constexpr (use_decoded_panels<nbits, es>) {
+		// x is decoded once and shared by all workers, the nonzeros of each row are decoded into the row panel of its worker
+		posit_panel<nbits, es> xp(nc, x);
+		parallel_sparse_rows<Scalar>(nr, starts, nrThreads, [&](size_t first, size_t last) {
+			posit_panel<nbits, es> row;
+			panel_quire_t<nbits, es, capacity> q;
+			for (size_t i = first; i < last; ++i) {
+				size_t begin = size_t(starts[i]);
+				size_t len = size_t(starts[i + 1]) - begin;
+				if (row.size() < len) row.resize(len);
+				row.decode(0, len, values + begin);
+				const Index* col = indices + begin;
+				q.reset();
+				for (size_t k = 0; k < len; ++k) {
+					size_t j = size_t(col[k]);
+					q.fma_decoded(row.significand()[k], row.scale()[k], row.flags()[k], xp.significand()[j], xp.scale()[j], xp.flags()[j]);
+				}
+				sw::universal::convert(q.to_value(), b[i]);     // one and only rounding step of the fused-dot product
+			}
+		});
+	}
+	else {
+		parallel_sparse_rows<Scalar>(nr, starts, nrThreads, [&](size_t first, size_t last) {
+			fused_quire_t<nbits, es, capacity> q;
+			for (size_t i = first; i < last; ++i) {
+				q.reset();
+				for (size_t k = size_t(starts[i]); k < size_t(starts[i + 1]); ++k) {
+					quire_fma(q, values[k], x[indices[k]]);
+				}
+				sw::universal::convert(q.to_value(), b[i]);     // one and only rounding step of the fused-dot product
+			}
+		});
+	}
+}
+
+// Sparse matrix-vector product: b = A * x, posit specialized for row-major compressed matrices
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es, typename Parameters>
+void matvec(mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& b, const mtl::mat::compressed2D< sw::universal::posit<nbits, es>, Parameters >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
+	using namespace mtl;
+	using Scalar = sw::universal::posit<nbits, es>;
+	static_assert(std::is_same_v<typename Parameters::orientation, mtl::tag::row_major>, "fused sparse matvec requires a row-major compressed matrix");
+	// preconditions
+	assert(A.num_cols() == size(x));
+	assert(A.num_rows() == size(b));
 
-#if HPRBLAS_TRACE_ROUNDING_EVENTS
-	unsigned errors = 0;
-#endif
 	size_t nr = size(b);
 	size_t nc = size(x);
-	for (size_t i = 0; i < nr; ++i) {
-		sw::universal::quire<nbits, es> q(0);
-		for (size_t j = 0; j < nc; ++j) {
-			q += sw::universal::quire_mul(A[i][j], x[j]);
+	if (nr == 0) return;
+	if (nc == 0 || A.nnz() == 0) {
+		for (size_t i = 0; i < nr; ++i) b[i] = Scalar(0);
+		return;
+	}
+	compressed_matvec<nbits, es>(nr, nc, A.address_major(), A.address_minor(), A.address_data(), &x[0], &b[0], nrThreads);
+}
+
+// A times x = b fused sparse matrix-vector product
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es, typename Parameters>
+mtl::vec::dense_vector< sw::universal::posit<nbits, es> > fmv(const mtl::mat::compressed2D< sw::universal::posit<nbits, es>, Parameters >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
+	using namespace mtl;
+	// preconditions
+	assert(A.num_cols() == size(x));
+	mtl::vec::dense_vector< sw::universal::posit<nbits, es> > b(A.num_rows());
+	matvec(b, A, x, nrThreads);
+	return b;
+}
+
+///
+/// symmetric matrix-vector products
+/// Only one triangle of a symmetric A is read. A stored element a_rc off the diagonal contributes
+/// a_rc * x[c] to b[r] and a_rc * x[r] to b[c], so it is read once and accumulated into the quires
+/// of both outputs, and each b[i] rounds once. The triangle is cut into tiles between row blocks
+/// I <= J. A tile updates the quires of the blocks I and J only, so the tiles are scheduled in
+/// rounds of a round-robin tournament between the blocks, in which no two tiles share a block,
+/// and the quires of every round are updated in parallel without synchronization.
+
+// the triangle of a symmetric matrix that is stored
+enum class triangle { upper, lower };
+
+// stored triangle of a symmetric matrix in a row-major n x n array
+template<typename Scalar>
+struct dense_triangle {
+	static constexpr bool column_major = false;
+	const Scalar* a;
+	size_t n;
+	const Scalar& operator()(size_t r, size_t c) const { return a[r * n + c]; }
+};
+
+// stored triangle of a symmetric matrix in the column-major packed layout of LAPACK:
+// upper AP[r + c(c+1)/2] for r <= c, lower AP[r + c(2n-c-1)/2] for r >= c
+template<typename Scalar>
+struct packed_triangle {
+	static constexpr bool column_major = true;
+	const Scalar* ap;
+	size_t n;
+	triangle uplo;
+	const Scalar& operator()(size_t r, size_t c) const {
+		return (uplo == triangle::upper ? ap[r + c * (c + 1) / 2] : ap[r + c * (2 * n - c - 1) / 2]);
+	}
+};
+
+// number of elements of the packed triangle of an n x n symmetric matrix
+constexpr size_t packed_size(size_t n) { return n * (n + 1) / 2; }
+
+// accumulates the stored elements of the tile between the row blocks [i0, i1) and [j0, j1), i0 <= j0, into q
+// a diagonal tile, i0 == j0, holds the stored triangle of the diagonal block
+template<typename Quire, typename Storage, typename Scalar>
+void symmetric_tile(std::vector<Quire>& q, const Storage& A, triangle uplo, const Scalar* x, size_t i0, size_t i1, size_t j0, size_t j1) {
+	bool diagonal = (i0 == j0);
+	// the stored rows and columns of the tile
+	size_t r0 = i0, r1 = i1, c0 = j0, c1 = j1;
+	if (uplo == triangle::lower) { r0 = j0; r1 = j1; c0 = i0; c1 = i1; }
+	auto element = [&](size_t r, size_t c) {
+		const Scalar& a = A(r, c);
+		quire_fma(q[r], a, x[c]);
+		if (r != c) quire_fma(q[c], a, x[r]);
+	};
+	if constexpr (Storage::column_major) {
+		for (size_t c = c0; c < c1; ++c) {
+			size_t first = r0, last = r1;
+			if (diagonal) { if (uplo == triangle::upper) last = c + 1; else first = c; }
+			for (size_t r = first; r < last; ++r) element(r, c);
 		}
-		sw::universal::convert(q.to_value(), b[i]);     // one and only rounding step of the fused-dot product
-#if HPRBLAS_TRACE_ROUNDING_EVENTS
-		sw::universal::quire<nbits, es> qdiff = q;
-		sw::universal::quire<nbits, es> qsum = b[i];
-		qdiff -= qsum;
-		if (!qdiff.iszero()) {
-			++errors;
-			std::cout << "q    : " << q << std::endl;
-			std::cout << "qsum : " << qsum << std::endl;
-			std::cout << "qdiff: " << qdiff << std::endl;
-			sw::universal::posit<nbits, es> roundingError;
-			convert(qdiff.to_value(), roundingError);
-			std::cout << "matvec b[" << i << "] = " << posit_format(b[i]) << " rounding error: " << posit_format(roundingError) << " " << roundingError << std::endl;
+	}
+	else {
+		for (size_t r = r0; r < r1; ++r) {
+			size_t first = c0, last = c1;
+			if (diagonal) { if (uplo == triangle::upper) first = r; else last = r + 1; }
+			for (size_t c = first; c < last; ++c) element(r, c);
 		}
-#endif
 	}
-#if HPRBLAS_TRACE_ROUNDING_EVENTS
-	if (errors) {
-		std::cout << "HPR-BLAS: tracing found " << errors << " rounding errors in matvec operation\n";
+}
+
+// Fused symmetric matrix-vector product b = A * x that reads only the stored triangle of A
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es, typename Storage, size_t capacity = 30>
+void symmetric_matvec(size_t n, const Storage& A, triangle uplo, const sw::universal::posit<nbits, es>* x, sw::universal::posit<nbits, es>* b, size_t nrThreads = 0) {
+	using Quire = fused_quire_t<nbits, es, capacity>;
+	if (n == 0) return;
+	std::vector<Quire> q(n);
+	// twice as many row blocks as workers give every round of the tournament a tile per worker
+	size_t nrWorkers = nr_of_blocks(packed_size(n), nrThreads, HPRBLAS_MATVEC_PARALLEL_GRAIN);
+	size_t nrBlocks = std::min(n, nrWorkers > 1 ? 2 * nrWorkers : size_t(1));
+	auto tile = [&](size_t I, size_t J) {
+		size_t i0, i1, j0, j1;
+		block_range(n, nrBlocks, I, i0, i1);
+		block_range(n, nrBlocks, J, j0, j1);
+		symmetric_tile(q, A, uplo, x, i0, i1, j0, j1);
+	};
+	// the diagonal tiles touch one block each
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t I) { tile(I, I); });
+	// circle method: with m even, round r pairs m-1 with r, and (r+k) with (r-k) modulo m-1; block nrBlocks is a bye
+	size_t m = nrBlocks + (nrBlocks % 2);
+	std::vector< std::pair<size_t, size_t> > pairs;
+	for (size_t round = 0; round + 1 < m; ++round) {
+		pairs.clear();
+		pairs.emplace_back(round, m - 1);
+		for (size_t k = 1; k < m / 2; ++k) pairs.emplace_back((round + k) % (m - 1), (round + m - 1 - k) % (m - 1));
+		for (auto& pair : pairs) if (pair.first > pair.second) std::swap(pair.first, pair.second);
+		pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [&](const std::pair<size_t, size_t>& pair) { return pair.second >= nrBlocks; }), pairs.end());
+		default_thread_pool().parallel_for(pairs.size(), [&](size_t t) { tile(pairs[t].first, pairs[t].second); });
+	}
+	default_thread_pool().parallel_for(nrBlocks, [&](size_t I) {
+		size_t first, last;
+		block_range(n, nrBlocks, I, first, last);
+		for (size_t i = first; i < last; ++i) sw::universal::convert(q[i].to_value(), b[i]);     // one and only rounding step of the fused-dot product
+	});
+}
+
+// A times x = b fused symmetric matrix-vector product, reading only the uplo triangle of A
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+mtl::vec::dense_vector< sw::universal::posit<nbits, es> > fsymv(triangle uplo, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
+	using namespace mtl;
+	using Scalar = sw::universal::posit<nbits, es>;
+	// preconditions
+	assert(A.num_rows() == A.num_cols());
+	assert(A.num_cols() == size(x));
+	size_t n = size(x);
+	mtl::vec::dense_vector<Scalar> b(n);
+	if (n > 0) symmetric_matvec<nbits, es>(n, dense_triangle<Scalar>{ A.address_data(), n }, uplo, &x[0], &b[0], nrThreads);
+	return b;
+}
+
+// A times x = b fused symmetric matrix-vector product of the uplo triangle of A packed into AP
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+mtl::vec::dense_vector< sw::universal::posit<nbits, es> > fspmv(triangle uplo, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& AP, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, size_t nrThreads = 0) {
+	using namespace mtl;
+	using Scalar = sw::universal::posit<nbits, es>;
+	size_t n = size(x);
+	// preconditions
+	assert(size(AP) == packed_size(n));
+	mtl::vec::dense_vector<Scalar> b(n);
+	if (n > 0) symmetric_matvec<nbits, es>(n, packed_triangle<Scalar>{ &AP[0], n, uplo }, uplo, &x[0], &b[0], nrThreads);
+	return b;
+}
+
+///
+/// fused rank-1 updates
+/// A = A + alpha * x * y^T rounds once per element of A: alpha * x[i] is formed once per row, as the
+/// reference BLAS does, and a_ij + (alpha * x[i]) * y[j] is accumulated in a quire and rounded once.
+/// With alpha = 1 or -1 the update is exact up to that rounding. The rows are split over the thread
+/// pool, and a worker sweeps its rows one chunk of columns at a time, so the chunk of y stays in cache.
+
+// A[i*nc + j] = A[i*nc + j] + t[i] * y[j] for j in [first(i), last(i)) of every row i, one rounding per element
+template<size_t nbits, size_t es, typename Columns>
+void rank1_update(size_t nr, size_t nc, const sw::universal::posit<nbits, es>* t, const sw::universal::posit<nbits, es>* y, sw::universal::posit<nbits, es>* A, Columns columns, size_t nrThreads) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	parallel_rows<Scalar>(nr, nc, nrThreads, [&](size_t firstRow, size_t lastRow) {
+		if constexpr (use_decoded_panels<nbits, es>) {
+			decoded_posit one = decode_posit(Scalar(1));
+			posit_panel<nbits, es> yp(HPRBLAS_FUSED_UPDATE_CHUNK), ap(HPRBLAS_FUSED_UPDATE_CHUNK);
+			panel_quire_t<nbits, es> q;
+			for (size_t chunk = 0; chunk < nc; chunk += HPRBLAS_FUSED_UPDATE_CHUNK) {
+				size_t chunkEnd = std::min(nc, chunk + HPRBLAS_FUSED_UPDATE_CHUNK);
+				yp.decode(0, chunkEnd - chunk, y + chunk);
+				for (size_t i = firstRow; i < lastRow; ++i) {
+					size_t first, last;
+					columns(i, first, last);
+					first = std::max(first, chunk);
+					last = std::min(last, chunkEnd);
+					if (first >= last) continue;
+					Scalar* row = A + i * nc;
+					ap.decode(0, last - first, row + first);
+					decoded_posit dt = decode_posit(t[i]);
+					unsigned flagsT = (dt.sign ? 1 : 0) | (dt.nar ? 2 : 0);
+					for (size_t j = first; j < last; ++j) {
+						size_t a = j - first, b = j - chunk;
+						q.reset();
+						q.fma_decoded(ap.significand()[a], ap.scale()[a], ap.flags()[a], one.significand, one.scale, 0);
+						q.fma_decoded(dt.significand, dt.scale, flagsT, yp.significand()[b], yp.scale()[b], yp.flags()[b]);
+						sw::universal::convert(q.to_value(), row[j]);     // one and only rounding step of the update
+					}
+				}
+			}
+		}
+		else {
+			Scalar one(1);
+			fused_quire_t<nbits, es> q;
+			for (size_t chunk = 0; chunk < nc; chunk += HPRBLAS_FUSED_UPDATE_CHUNK) {
+				size_t chunkEnd = std::min(nc, chunk + HPRBLAS_FUSED_UPDATE_CHUNK);
+				for (size_t i = firstRow; i < lastRow; ++i) {
+					size_t first, last;
+					columns(i, first, last);
+					Scalar* row = A + i * nc;
+					for (size_t j = std::max(first, chunk); j < std::min(last, chunkEnd); ++j) {
+						q.reset();
+						quire_fma(q, row[j], one);
+						quire_fma(q, t[i], y[j]);
+						sw::universal::convert(q.to_value(), row[j]);     // one and only rounding step of the update
+					}
+				}
+			}
+		}
+	});
+}
+
+// fused rank-1 update A = A + alpha * x * y^T, in place
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+void fger(const sw::universal::posit<nbits, es>& alpha, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& y, mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, size_t nrThreads = 0) {
+	using namespace mtl;
+	using Scalar = sw::universal::posit<nbits, es>;
+	// preconditions
+	assert(A.num_rows() == size(x));
+	assert(A.num_cols() == size(y));
+	size_t nr = size(x);
+	size_t nc = size(y);
+	if (nr == 0 || nc == 0 || alpha.iszero()) return;
+	std::vector<Scalar> t(nr);
+	for (size_t i = 0; i < nr; ++i) t[i] = alpha * x[i];
+	rank1_update<nbits, es>(nr, nc, t.data(), &y[0], A.address_data(), [nc](size_t, size_t& first, size_t& last) { first = 0; last = nc; }, nrThreads);
+}
+
+// fused symmetric rank-1 update A = A + alpha * x * x^T of the uplo triangle of A, in place
+// the other triangle is neither read nor written
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+void fsyr(triangle uplo, const sw::universal::posit<nbits, es>& alpha, const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& x, mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, size_t nrThreads = 0) {
+	using namespace mtl;
+	using Scalar = sw::universal::posit<nbits, es>;
+	// preconditions
+	assert(A.num_rows() == A.num_cols());
+	assert(A.num_cols() == size(x));
+	size_t n = size(x);
+	if (n == 0 || alpha.iszero()) return;
+	std::vector<Scalar> t(n);
+	for (size_t i = 0; i < n; ++i) t[i] = alpha * x[i];
+	if (uplo == triangle::upper) {
+		rank1_update<nbits, es>(n, n, t.data(), &x[0], A.address_data(), [n](size_t i, size_t& first, size_t& last) { first = i; last = n; }, nrThreads);
+	}
+	else {
+		rank1_update<nbits, es>(n, n, t.data(), &x[0], A.address_data(), [](size_t i, size_t& first, size_t& last) { first = 0; last = i + 1; }, nrThreads);
+	}
+}
+
+// A times x = b fused matrix-vector product of complex posits, rounded once per component of b
+template<size_t nbits, size_t es>
+mtl::vec::dense_vector< std::complex< sw::universal::posit<nbits, es> > > fmv(const mtl::mat::dense2D< std::complex< sw::universal::posit<nbits, es> > >& A, const mtl::vec::dense_vector< std::complex< sw::universal::posit<nbits, es> > >& x) {
+	using namespace mtl;
+	// preconditions
+	assert(A.num_cols() == size(x));
+	size_t nr = A.num_rows();
+	size_t nc = size(x);
+	mtl::vec::dense_vector< std::complex< sw::universal::posit<nbits, es> > > b(nr);
+	complex_quire<nbits, es> q;
+	for (size_t i = 0; i < nr; ++i) {
+		q.reset();
+		for (size_t j = 0; j < nc; ++j) {
+			q.fma(A[i][j], x[j]);
+		}
+		convert(q, b[i]);     // one and only rounding step of each component of the fused-dot product
 	}
-#endif
 	return b;
 }
 
@@ -313,6 +1723,24 @@ void matmul(Matrix& C, const Matrix& A, const Matrix& B) {
 	C = A * B;
 }
 
+// Fused matrix-matrix product C = A * B over row-major arrays:
+// B is decoded once into a panel of its columns, and each row of A once into a row panel
+template<size_t nbits, size_t es, size_t capacity = 30>
+void panel_matmul(size_t nr, size_t nc, size_t nk, const sw::universal::posit<nbits, es>* A, const sw::universal::posit<nbits, es>* B, sw::universal::posit<nbits, es>* C) {
+	posit_panel<nbits, es> columns(nc * nk);
+	for (size_t j = 0; j < nc; ++j) columns.decode(j * nk, nk, B + j, nc);
+	posit_panel<nbits, es> row(nk);
+	panel_quire_t<nbits, es, capacity> q;
+	for (size_t i = 0; i < nr; ++i) {
+		row.decode(0, nk, A + i * nk);
+		for (size_t j = 0; j < nc; ++j) {
+			q.reset();
+			fdp_qr(q, nk, row, 0, columns, j * nk);
+			sw::universal::convert(q.to_value(), C[i * nc + j]);     // one and only rounding step of the fused-dot product
+		}
+	}
+}
+
 // C = A * B fused matrix-matrix product when posits are used
 template<size_t nbits, size_t es>
 void matmul(mtl::mat::dense2D< sw::universal::posit<nbits, es> >& C, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& B) {
@@ -323,11 +1751,17 @@ void matmul(mtl::mat::dense2D< sw::universal::posit<nbits, es> >& C, const mtl::
 	size_t nk = A.num_cols();
 	// TODO: add asserts to make certain that C is the right size
 
+	if constexpr (use_decoded_panels<nbits, es>) {
+		if (nr > 0 && nc > 0 && nk > 0) {
+			panel_matmul<nbits, es>(nr, nc, nk, A.address_data(), B.address_data(), C.address_data());
+			return;
+		}
+	}
 	for (size_t i = 0; i < nr; ++i) {
 		for (size_t j = 0; j < nc; ++j) {
-			sw::universal::quire<nbits, es> q(0);
+			fused_quire_t<nbits, es> q(0);
 			for (size_t k = 0; k < nk; ++k) {
-				q += sw::universal::quire_mul(A[i][k], B[k][j]);
+				quire_fma(q, A[i][k], B[k][j]);
 			}
 			sw::universal::convert(q.to_value(), C[i][j]);     // one and only rounding step of the fused-dot product
 		}
@@ -344,11 +1778,17 @@ mtl::mat::dense2D< sw::universal::posit<nbits, es> > fmm(const mtl::mat::dense2D
 	size_t nk = A.num_cols();
 	mtl::mat::dense2D< sw::universal::posit<nbits, es> > C(nr, nc);
 
+	if constexpr (use_decoded_panels<nbits, es>) {
+		if (nr > 0 && nc > 0 && nk > 0) {
+			panel_matmul<nbits, es>(nr, nc, nk, A.address_data(), B.address_data(), C.address_data());
+			return C;
+		}
+	}
 	for (size_t i = 0; i < nr; ++i) {
 		for (size_t j = 0; j < nc; ++j) {
-			sw::universal::quire<nbits, es> q(0);
+			fused_quire_t<nbits, es> q(0);
 			for (size_t k = 0; k < nk; ++k) {
-				q += sw::universal::quire_mul(A[i][k], B[k][j]);
+				quire_fma(q, A[i][k], B[k][j]);
 			}
 			sw::universal::convert(q.to_value(), C[i][j]);     // one and only rounding step of the fused-dot product
 		}
@@ -356,6 +1796,111 @@ mtl::mat::dense2D< sw::universal::posit<nbits, es> > fmm(const mtl::mat::dense2D
 	return C;
 }
 
+// C = A * B fused matrix-matrix product of complex posits, rounded once per component of C
+template<size_t nbits, size_t es>
+mtl::mat::dense2D< std::complex< sw::universal::posit<nbits, es> > > fmm(const mtl::mat::dense2D< std::complex< sw::universal::posit<nbits, es> > >& A, const mtl::mat::dense2D< std::complex< sw::universal::posit<nbits, es> > >& B) {
+	// precondition
+	assert(A.num_cols() == B.num_rows());
+	size_t nr = A.num_rows();
+	size_t nc = B.num_cols();
+	size_t nk = A.num_cols();
+	mtl::mat::dense2D< std::complex< sw::universal::posit<nbits, es> > > C(nr, nc);
+	complex_quire<nbits, es> q;
+	for (size_t i = 0; i < nr; ++i) {
+		for (size_t j = 0; j < nc; ++j) {
+			q.reset();
+			for (size_t k = 0; k < nk; ++k) {
+				q.fma(A[i][k], B[k][j]);
+			}
+			convert(q, C[i][j]);     // one and only rounding step of each component of the fused-dot product
+		}
+	}
+	return C;
+}
+
+///
+/// fused rank-k update
+/// C = alpha * A * A^T + beta * C on the uplo triangle of C rounds once per element of C: alpha * A is
+/// formed once per element of A, as the reference BLAS does, and beta * c_ij and the row products of
+/// the scaled and the original A are accumulated in a quire and rounded once. With alpha = 1 or -1
+/// the update is exact up to that rounding. The triangle of C is cut into square tiles, and a tile
+/// computes the dot products between its block of rows of A, so the rows of a tile are reused from
+/// cache. Tiles write disjoint elements of C and are split over the thread pool.
+
+// number of rows and columns of a tile of C
+constexpr size_t HPRBLAS_RANK_K_BLOCK = 64;
+
+// fused symmetric rank-k update C = alpha * A * A^T + beta * C of the uplo triangle of C, in place
+// A is n x k and C is n x n; the other triangle of C is neither read nor written, and C is not read when beta is 0
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+void fsyrk(triangle uplo, const sw::universal::posit<nbits, es>& alpha, const mtl::mat::dense2D< sw::universal::posit<nbits, es> >& A, const sw::universal::posit<nbits, es>& beta, mtl::mat::dense2D< sw::universal::posit<nbits, es> >& C, size_t nrThreads = 0) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	// preconditions
+	assert(C.num_rows() == C.num_cols());
+	assert(A.num_rows() == C.num_rows());
+	size_t n = A.num_rows();
+	size_t k = A.num_cols();
+	if (n == 0) return;
+	bool scaled = !(alpha == Scalar(1));
+	bool accumulate = !beta.iszero();
+	const Scalar* a = (k > 0 ? A.address_data() : nullptr);
+	std::vector<Scalar> alphaA;
+	if (scaled) {
+		alphaA.resize(n * k);
+		for (size_t i = 0; i < n * k; ++i) alphaA[i] = alpha * a[i];
+	}
+	const Scalar* t = (scaled ? alphaA.data() : a);
+	Scalar* c = C.address_data();
+
+	// tiles (I, J) of the upper triangle, I <= J; the lower triangle is served by their transposes
+	size_t nrTiles = (n + HPRBLAS_RANK_K_BLOCK - 1) / HPRBLAS_RANK_K_BLOCK;
+	std::vector< std::pair<size_t, size_t> > tiles;
+	for (size_t I = 0; I < nrTiles; ++I) for (size_t J = I; J < nrTiles; ++J) tiles.emplace_back(I, J);
+	size_t tileProducts = HPRBLAS_RANK_K_BLOCK * HPRBLAS_RANK_K_BLOCK * std::max<size_t>(1, k);
+	size_t nrBlocks = nr_of_blocks(tiles.size(), nrThreads, std::max<size_t>(1, HPRBLAS_MATVEC_PARALLEL_GRAIN / tileProducts));
+
+	// the sweep over the tiles, with a quire of the given type per worker and dot(q, r, s) accumulating row r of A
+	// times row s of alpha * A
+	auto sweep = [&](auto prototype, auto dot) {
+		default_thread_pool().parallel_for(nrBlocks, [&](size_t blk) {
+			size_t firstTile, lastTile;
+			block_range(tiles.size(), nrBlocks, blk, firstTile, lastTile);
+			auto q = prototype;
+			for (size_t tile = firstTile; tile < lastTile; ++tile) {
+				size_t i0 = tiles[tile].first * HPRBLAS_RANK_K_BLOCK, i1 = std::min(n, i0 + HPRBLAS_RANK_K_BLOCK);
+				size_t j0 = tiles[tile].second * HPRBLAS_RANK_K_BLOCK, j1 = std::min(n, j0 + HPRBLAS_RANK_K_BLOCK);
+				for (size_t i = i0; i < i1; ++i) {
+					for (size_t j = std::max(i, j0); j < j1; ++j) {
+						// the stored element (r, s) of the pair (i, j), i <= j
+						size_t r = (uplo == triangle::upper ? i : j);
+						size_t s = (uplo == triangle::upper ? j : i);
+						Scalar& crs = c[r * n + s];
+						q.reset();
+						if (accumulate) quire_fma(q, beta, crs);
+						dot(q, r, s);
+						sw::universal::convert(q.to_value(), crs);     // one and only rounding step of the update
+					}
+				}
+			}
+		});
+	};
+	if constexpr (use_decoded_panels<nbits, es>) {
+		// A, and alpha * A, are decoded once into panels shared by all workers
+		posit_panel<nbits, es> ap(n * k, a);
+		posit_panel<nbits, es> tp;
+		if (scaled) {
+			tp.resize(n * k);
+			tp.decode(0, n * k, t);
+		}
+		const posit_panel<nbits, es>& sp = (scaled ? tp : ap);
+		sweep(panel_quire_t<nbits, es>(), [&](panel_quire_t<nbits, es>& q, size_t r, size_t s) { fdp_qr(q, k, ap, r * k, sp, s * k); });
+	}
+	else {
+		sweep(fused_quire_t<nbits, es>(), [&](fused_quire_t<nbits, es>& q, size_t r, size_t s) { fdp_qr(q, k, a + r * k, t + s * k); });
+	}
+}
+
 template<typename Scalar>
 inline Scalar minimum(const Scalar& a, const Scalar& b) {
 	return (a < b ? a : b);
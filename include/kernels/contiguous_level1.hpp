@@ -0,0 +1,287 @@
+#pragma once
+// contiguous_level1.hpp: Level-1 kernels over contiguous, unit stride arrays
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+#include <quire/posit_decode.hpp>
+#include <quire/quire_traits.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ Level-1 kernels for unit stride operands held in contiguous memory. The strided operators
+ in hprblas.hpp dispatch here when incx == incy == 1 and the vectors are dense.
+
+ float and double kernels are unrolled over AVX-512 or AVX registers. Products and sums are
+ rounded separately, as the reference BLAS writes them: the kernels that add products are
+ compiled without contraction into fused multiply-adds, whatever -ffp-contract the build uses,
+ so their results do not depend on the FMA support of the target. Posit kernels resolve the
+ multipliers 0, 1 and -1 on the bit patterns, where the result is exact, and otherwise walk the
+ arrays through raw pointers.
+ */
+
+// HPRBLAS_NO_FP_CONTRACT marks a function, and HPRBLAS_NO_FP_CONTRACT_SCOPE opens its body,
+// so that products and sums in it are never contracted into a fused multiply-add
+#if defined(__clang__)
+#define HPRBLAS_NO_FP_CONTRACT
+#define HPRBLAS_NO_FP_CONTRACT_SCOPE _Pragma("clang fp contract(off)")
+#elif defined(__GNUC__)
+#define HPRBLAS_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#define HPRBLAS_NO_FP_CONTRACT_SCOPE
+#else
+#define HPRBLAS_NO_FP_CONTRACT
+#define HPRBLAS_NO_FP_CONTRACT_SCOPE
+#endif
+
+namespace detail {
+
+// register abstraction of the unrolled float and double kernels
+template<typename Real> struct simd_lanes;
+#if defined(__AVX512F__)
+#define HPRBLAS_SIMD_LEVEL1 1
+template<> struct simd_lanes<double> {
+	using type = __m512d;
+	static constexpr size_t width = 8;
+	static type load(const double* p) { return _mm512_loadu_pd(p); }
+	static void store(double* p, type v) { _mm512_storeu_pd(p, v); }
+	static type broadcast(double a) { return _mm512_set1_pd(a); }
+	static type add(type a, type b) { return _mm512_add_pd(a, b); }
+	static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+	static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+};
+template<> struct simd_lanes<float> {
+	using type = __m512;
+	static constexpr size_t width = 16;
+	static type load(const float* p) { return _mm512_loadu_ps(p); }
+	static void store(float* p, type v) { _mm512_storeu_ps(p, v); }
+	static type broadcast(float a) { return _mm512_set1_ps(a); }
+	static type add(type a, type b) { return _mm512_add_ps(a, b); }
+	static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+	static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+};
+#elif defined(__AVX__)
+#define HPRBLAS_SIMD_LEVEL1 1
+template<> struct simd_lanes<double> {
+	using type = __m256d;
+	static constexpr size_t width = 4;
+	static type load(const double* p) { return _mm256_loadu_pd(p); }
+	static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+	static type broadcast(double a) { return _mm256_set1_pd(a); }
+	static type add(type a, type b) { return _mm256_add_pd(a, b); }
+	static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+	static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+};
+template<> struct simd_lanes<float> {
+	using type = __m256;
+	static constexpr size_t width = 8;
+	static type load(const float* p) { return _mm256_loadu_ps(p); }
+	static void store(float* p, type v) { _mm256_storeu_ps(p, v); }
+	static type broadcast(float a) { return _mm256_set1_ps(a); }
+	static type add(type a, type b) { return _mm256_add_ps(a, b); }
+	static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+	static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+};
+#endif
+
+// y += a * x
+template<typename Real>
+HPRBLAS_NO_FP_CONTRACT void simd_axpy(size_t n, Real a, const Real* x, Real* y) {
+	HPRBLAS_NO_FP_CONTRACT_SCOPE
+	size_t i = 0;
+#if defined(HPRBLAS_SIMD_LEVEL1)
+	using V = simd_lanes<Real>;
+	constexpr size_t w = V::width;
+	typename V::type va = V::broadcast(a);
+	for (; i + 4 * w <= n; i += 4 * w) {
+		typename V::type p0 = V::mul(va, V::load(x + i));
+		typename V::type p1 = V::mul(va, V::load(x + i + w));
+		typename V::type p2 = V::mul(va, V::load(x + i + 2 * w));
+		typename V::type p3 = V::mul(va, V::load(x + i + 3 * w));
+		V::store(y + i,         V::add(V::load(y + i), p0));
+		V::store(y + i + w,     V::add(V::load(y + i + w), p1));
+		V::store(y + i + 2 * w, V::add(V::load(y + i + 2 * w), p2));
+		V::store(y + i + 3 * w, V::add(V::load(y + i + 3 * w), p3));
+	}
+	for (; i + w <= n; i += w) V::store(y + i, V::add(V::load(y + i), V::mul(va, V::load(x + i))));
+#endif
+	for (; i < n; ++i) y[i] += a * x[i];
+}
+
+// x *= a
+template<typename Real>
+void simd_scale(size_t n, Real a, Real* x) {
+	size_t i = 0;
+#if defined(HPRBLAS_SIMD_LEVEL1)
+	using V = simd_lanes<Real>;
+	constexpr size_t w = V::width;
+	typename V::type va = V::broadcast(a);
+	for (; i + 4 * w <= n; i += 4 * w) {
+		V::store(x + i,         V::mul(V::load(x + i), va));
+		V::store(x + i + w,     V::mul(V::load(x + i + w), va));
+		V::store(x + i + 2 * w, V::mul(V::load(x + i + 2 * w), va));
+		V::store(x + i + 3 * w, V::mul(V::load(x + i + 3 * w), va));
+	}
+	for (; i + w <= n; i += w) V::store(x + i, V::mul(V::load(x + i), va));
+#endif
+	for (; i < n; ++i) x[i] *= a;
+}
+
+// (x, y) = (c*x + s*y, c*y - s*x)
+template<typename Real>
+HPRBLAS_NO_FP_CONTRACT void simd_rot(size_t n, Real* x, Real* y, Real c, Real s) {
+	HPRBLAS_NO_FP_CONTRACT_SCOPE
+	size_t i = 0;
+#if defined(HPRBLAS_SIMD_LEVEL1)
+	using V = simd_lanes<Real>;
+	constexpr size_t w = V::width;
+	typename V::type vc = V::broadcast(c), vs = V::broadcast(s);
+	for (; i + 2 * w <= n; i += 2 * w) {
+		typename V::type x0 = V::load(x + i), x1 = V::load(x + i + w);
+		typename V::type y0 = V::load(y + i), y1 = V::load(y + i + w);
+		V::store(x + i,     V::add(V::mul(vc, x0), V::mul(vs, y0)));
+		V::store(x + i + w, V::add(V::mul(vc, x1), V::mul(vs, y1)));
+		V::store(y + i,     V::sub(V::mul(vc, y0), V::mul(vs, x0)));
+		V::store(y + i + w, V::sub(V::mul(vc, y1), V::mul(vs, x1)));
+	}
+	for (; i + w <= n; i += w) {
+		typename V::type x0 = V::load(x + i), y0 = V::load(y + i);
+		V::store(x + i, V::add(V::mul(vc, x0), V::mul(vs, y0)));
+		V::store(y + i, V::sub(V::mul(vc, y0), V::mul(vs, x0)));
+	}
+#endif
+	for (; i < n; ++i) {
+		Real x_i = c*x[i] + s*y[i];
+		Real y_i = c*y[i] - s*x[i];
+		y[i] = y_i;
+		x[i] = x_i;
+	}
+}
+
+// posit multipliers whose product is a bit pattern operation
+enum class posit_multiplier { zero, one, minus_one, general };
+
+template<size_t nbits, size_t es>
+posit_multiplier classify_multiplier(const sw::universal::posit<nbits, es>& a) {
+	constexpr uint64_t mask = (nbits == 64 ? ~uint64_t(0) : ((uint64_t(1) << nbits) - 1));
+	uint64_t bits = posit_bits(a);
+	if (bits == 0) return posit_multiplier::zero;
+	if (bits == (uint64_t(1) << (nbits - 2))) return posit_multiplier::one;
+	if (bits == ((~(uint64_t(1) << (nbits - 2)) + 1) & mask)) return posit_multiplier::minus_one;
+	return posit_multiplier::general;
+}
+
+// negation of a posit is the two's complement of its bit pattern, which maps 0 and NaR onto themselves
+template<size_t nbits, size_t es>
+inline void negate_bits(sw::universal::posit<nbits, es>& p) {
+	constexpr uint64_t mask = (nbits == 64 ? ~uint64_t(0) : ((uint64_t(1) << nbits) - 1));
+	p.setbits((~posit_bits(p) + 1) & mask);
+}
+
+template<size_t nbits, size_t es>
+inline bool is_nar_bits(const sw::universal::posit<nbits, es>& p) {
+	return posit_bits(p) == (uint64_t(1) << (nbits - 1));
+}
+
+// y += a * x
+template<size_t nbits, size_t es>
+void posit_axpy(size_t n, const sw::universal::posit<nbits, es>& a, const sw::universal::posit<nbits, es>* x, sw::universal::posit<nbits, es>* y) {
+	switch (classify_multiplier(a)) {
+	case posit_multiplier::zero:         // 0 * x is 0, unless x is NaR
+		for (size_t i = 0; i < n; ++i) if (is_nar_bits(x[i])) y[i].setbits(uint64_t(1) << (nbits - 1));
+		break;
+	case posit_multiplier::one:
+		for (size_t i = 0; i < n; ++i) y[i] += x[i];
+		break;
+	case posit_multiplier::minus_one:
+		for (size_t i = 0; i < n; ++i) y[i] -= x[i];
+		break;
+	default:
+		for (size_t i = 0; i < n; ++i) y[i] += a * x[i];
+	}
+}
+
+// x *= a
+template<size_t nbits, size_t es>
+void posit_scale(size_t n, const sw::universal::posit<nbits, es>& a, sw::universal::posit<nbits, es>* x) {
+	switch (classify_multiplier(a)) {
+	case posit_multiplier::zero:         // 0 * x is 0, unless x is NaR
+		for (size_t i = 0; i < n; ++i) if (!is_nar_bits(x[i])) x[i].setbits(0);
+		break;
+	case posit_multiplier::one:
+		break;
+	case posit_multiplier::minus_one:
+		for (size_t i = 0; i < n; ++i) negate_bits(x[i]);
+		break;
+	default:
+		for (size_t i = 0; i < n; ++i) x[i] *= a;
+	}
+}
+
+} // namespace detail
+
+// y[0..n) += a * x[0..n)
+template<typename Scalar, typename T>
+void contiguous_axpy(size_t n, const Scalar& a, const T* x, T* y) {
+	if constexpr (is_ieee_binary_v<T> && std::is_same_v<Scalar, T>) {
+		detail::simd_axpy(n, a, x, y);
+	}
+	else if constexpr (is_posit_v<T>) {
+		detail::posit_axpy(n, T(a), x, y);
+	}
+	else {
+		for (size_t i = 0; i < n; ++i) y[i] += a * x[i];
+	}
+}
+
+// y[0..n) = x[0..n)
+template<typename T>
+void contiguous_copy(size_t n, const T* x, T* y) {
+	std::copy_n(x, n, y);     // a block move for trivially copyable element types
+}
+
+// x[0..n) *= a
+template<typename Scalar, typename T>
+void contiguous_scale(size_t n, const Scalar& a, T* x) {
+	if constexpr (is_ieee_binary_v<T> && std::is_same_v<Scalar, T>) {
+		detail::simd_scale(n, a, x);
+	}
+	else if constexpr (is_posit_v<T>) {
+		detail::posit_scale(n, T(a), x);
+	}
+	else {
+		for (size_t i = 0; i < n; ++i) x[i] *= a;
+	}
+}
+
+// exchange x[0..n) and y[0..n)
+template<typename T>
+void contiguous_swap(size_t n, T* x, T* y) {
+	std::swap_ranges(x, x + n, y);
+}
+
+// apply the plane rotation (c, s) to the points (x[i], y[i]), i in [0, n)
+template<typename Rotation, typename T>
+void contiguous_rot(size_t n, T* x, T* y, const Rotation& c, const Rotation& s) {
+	if constexpr (is_ieee_binary_v<T> && std::is_same_v<Rotation, T>) {
+		detail::simd_rot(n, x, y, c, s);
+	}
+	else {
+		for (size_t i = 0; i < n; ++i) {
+			Rotation x_i = c*x[i] + s*y[i];
+			Rotation y_i = c*y[i] - s*x[i];
+			y[i] = y_i;
+			x[i] = x_i;
+		}
+	}
+}
+
+}} // namespace sw::hprblas
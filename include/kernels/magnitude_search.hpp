@@ -0,0 +1,160 @@
+#pragma once
+// magnitude_search.hpp: index of the element of largest or smallest magnitude
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+#include <type_traits>
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include <quire/posit_decode.hpp>
+#include <quire/quire_traits.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ Posit encodings order like two's complement integers, and the magnitude of a posit is the two's
+ complement of its encoding when the sign bit is set. IEEE encodings with the sign bit cleared
+ order like unsigned integers. The magnitude search maps elements to these unsigned keys, a chunk
+ at a time, and reduces the chunk with integer max or min instructions. The position of the first
+ extreme key is looked up only in a chunk that improves on the extreme found so far.
+
+ NaR maps onto the largest key, 2^(nbits-1), and IEEE NaNs onto keys above that of infinity, so a
+ search for the largest magnitude reports the first NaR or NaN, and a search for the smallest
+ magnitude skips them unless all elements are NaR or NaN.
+ */
+
+// unsigned key that orders elements by magnitude
+template<typename Scalar>
+struct magnitude_key;
+
+template<size_t nbits, size_t es>
+struct magnitude_key< sw::universal::posit<nbits, es> > {
+	static_assert(nbits <= 64, "magnitude_key requires nbits <= 64");
+	using type = std::conditional_t<(nbits <= 32), uint32_t, uint64_t>;
+	static type of(const sw::universal::posit<nbits, es>& p) {
+		constexpr uint64_t mask = (nbits == 64 ? ~uint64_t(0) : ((uint64_t(1) << nbits) - 1));
+		uint64_t bits = posit_bits(p);
+		if (bits & (uint64_t(1) << (nbits - 1))) bits = (~bits + 1) & mask;   // NaR maps onto itself
+		return type(bits);
+	}
+};
+template<>
+struct magnitude_key<float> {
+	using type = uint32_t;
+	static type of(float v) { return std::bit_cast<uint32_t>(v) & 0x7FFFFFFFu; }
+};
+template<>
+struct magnitude_key<double> {
+	using type = uint64_t;
+	static type of(double v) { return std::bit_cast<uint64_t>(v) & 0x7FFFFFFFFFFFFFFFull; }
+};
+
+namespace detail {
+
+// number of keys staged and reduced at a time
+constexpr size_t magnitude_search_chunk = 1024;
+
+// largest (Largest = true) or smallest key of k[0..n), n > 0
+template<bool Largest>
+uint32_t extreme_key(size_t n, const uint32_t* k) {
+	size_t i = 0;
+	uint32_t best = k[0];
+#if defined(__AVX512F__)
+	if (n >= 32) {
+		__m512i b0 = _mm512_loadu_si512(k), b1 = _mm512_loadu_si512(k + 16);
+		for (i = 32; i + 32 <= n; i += 32) {
+			__m512i v0 = _mm512_loadu_si512(k + i), v1 = _mm512_loadu_si512(k + i + 16);
+			b0 = Largest ? _mm512_max_epu32(b0, v0) : _mm512_min_epu32(b0, v0);
+			b1 = Largest ? _mm512_max_epu32(b1, v1) : _mm512_min_epu32(b1, v1);
+		}
+		b0 = Largest ? _mm512_max_epu32(b0, b1) : _mm512_min_epu32(b0, b1);
+		best = Largest ? _mm512_reduce_max_epu32(b0) : _mm512_reduce_min_epu32(b0);
+	}
+#elif defined(__AVX2__)
+	if (n >= 16) {
+		__m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k));
+		__m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k + 8));
+		for (i = 16; i + 16 <= n; i += 16) {
+			__m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k + i));
+			__m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k + i + 8));
+			b0 = Largest ? _mm256_max_epu32(b0, v0) : _mm256_min_epu32(b0, v0);
+			b1 = Largest ? _mm256_max_epu32(b1, v1) : _mm256_min_epu32(b1, v1);
+		}
+		b0 = Largest ? _mm256_max_epu32(b0, b1) : _mm256_min_epu32(b0, b1);
+		alignas(32) uint32_t lane[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lane), b0);
+		best = lane[0];
+		for (size_t j = 1; j < 8; ++j) best = (Largest ? (lane[j] > best) : (lane[j] < best)) ? lane[j] : best;
+	}
+#endif
+	for (; i < n; ++i) best = (Largest ? (k[i] > best) : (k[i] < best)) ? k[i] : best;
+	return best;
+}
+
+template<bool Largest>
+uint64_t extreme_key(size_t n, const uint64_t* k) {
+	size_t i = 0;
+	uint64_t best = k[0];
+#if defined(__AVX512F__)
+	if (n >= 16) {
+		__m512i b0 = _mm512_loadu_si512(k), b1 = _mm512_loadu_si512(k + 8);
+		for (i = 16; i + 16 <= n; i += 16) {
+			__m512i v0 = _mm512_loadu_si512(k + i), v1 = _mm512_loadu_si512(k + i + 8);
+			b0 = Largest ? _mm512_max_epu64(b0, v0) : _mm512_min_epu64(b0, v0);
+			b1 = Largest ? _mm512_max_epu64(b1, v1) : _mm512_min_epu64(b1, v1);
+		}
+		b0 = Largest ? _mm512_max_epu64(b0, b1) : _mm512_min_epu64(b0, b1);
+		best = Largest ? _mm512_reduce_max_epu64(b0) : _mm512_reduce_min_epu64(b0);
+	}
+#endif
+	for (; i < n; ++i) best = (Largest ? (k[i] > best) : (k[i] < best)) ? k[i] : best;
+	return best;
+}
+
+} // namespace detail
+
+// element number k in [0, m) of the first element x[k*incx] of largest (Largest = true)
+// or smallest magnitude; returns 0 when m is 0
+template<bool Largest, typename Vector>
+size_t magnitude_search(size_t m, const Vector& x, size_t incx) {
+	using Scalar = typename Vector::value_type;
+	if (m == 0) return 0;
+	size_t index = 0;
+	if constexpr (is_posit_v<Scalar> || is_ieee_binary_v<Scalar>) {
+		using Key = typename magnitude_key<Scalar>::type;
+		Key keys[detail::magnitude_search_chunk];
+		Key best = 0;
+		for (size_t first = 0; first < m; first += detail::magnitude_search_chunk) {
+			size_t len = std::min(detail::magnitude_search_chunk, m - first);
+			for (size_t i = 0; i < len; ++i) keys[i] = magnitude_key<Scalar>::of(x[(first + i) * incx]);
+			Key extreme = detail::extreme_key<Largest>(len, keys);
+			if (first == 0 || (Largest ? (extreme > best) : (extreme < best))) {
+				best = extreme;
+				size_t i = 0;
+				while (keys[i] != extreme) ++i;
+				index = first + i;
+			}
+		}
+	}
+	else {
+		auto magnitude = [](const Scalar& v) { return (v < 0 ? -v : v); };
+		Scalar best = magnitude(x[0]);
+		for (size_t k = 1; k < m; ++k) {
+			Scalar v = magnitude(x[k * incx]);
+			if (Largest ? (v > best) : (v < best)) {
+				best = v;
+				index = k;
+			}
+		}
+	}
+	return index;
+}
+
+}} // namespace sw::hprblas
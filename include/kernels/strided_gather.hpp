@@ -0,0 +1,84 @@
+#pragma once
+// strided_gather.hpp: packing of strided operands into contiguous blocks for the fused kernels
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <algorithm>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#endif
+
+namespace sw {
+namespace hprblas {
+
+/*
+ A strided operand, such as a column of a row-major matrix, touches a new cache line with every
+ element, and the hardware prefetchers do not follow strides of more than a few lines. The packing
+ layer gathers a block of elements of both operands into contiguous, aligned scratch buffers and
+ hands the block to the contiguous kernel. Before the kernel consumes a block, the cache lines of
+ the next block are requested with software prefetches, so the memory traffic of the next gather
+ overlaps with the accumulation of the current block.
+
+ The blocks are consumed in index order, so an exact accumulator sees the products in the order
+ of the strided loop, and the results are bitwise identical to it.
+ */
+
+// number of elements of each operand gathered per block
+constexpr size_t HPRBLAS_GATHER_BLOCK = 256;
+
+inline void prefetch_read(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER)
+	_mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+	(void)p;
+#endif
+}
+
+// request the cache lines of the n elements x[0], x[incx], ..., x[(n-1)*incx]
+template<typename Scalar>
+inline void prefetch_strided(size_t n, const Scalar* x, size_t incx) {
+	for (size_t k = 0; k < n; ++k) prefetch_read(x + k * incx);
+}
+
+// copy the n elements x[0], x[incx], ..., x[(n-1)*incx] into the contiguous buffer xb
+template<typename Scalar>
+inline void gather_strided(size_t n, const Scalar* x, size_t incx, Scalar* xb) {
+	if (incx == 1) {
+		std::copy(x, x + n, xb);
+		return;
+	}
+	for (size_t k = 0; k < n; ++k) xb[k] = x[k * incx];
+}
+
+// call consume(len, xb, yb) on consecutive blocks of the pairs (x[k*incx], y[k*incy]), k in [0, n),
+// gathered into contiguous aligned buffers; the blocks are consumed in index order
+template<typename Scalar, typename Consume>
+void packed_pairs(size_t n, const Scalar* x, size_t incx, const Scalar* y, size_t incy, Consume consume) {
+	if (n == 0) return;
+	alignas(64) Scalar xb[HPRBLAS_GATHER_BLOCK];
+	alignas(64) Scalar yb[HPRBLAS_GATHER_BLOCK];
+	size_t len = std::min(HPRBLAS_GATHER_BLOCK, n);
+	gather_strided(len, x, incx, xb);
+	gather_strided(len, y, incy, yb);
+	for (size_t k = 0; k < n; ) {
+		size_t next = k + len;
+		size_t nextLen = std::min(HPRBLAS_GATHER_BLOCK, n - next);
+		if (nextLen > 0) {
+			if (incx != 1) prefetch_strided(nextLen, x + next * incx, incx);
+			if (incy != 1) prefetch_strided(nextLen, y + next * incy, incy);
+		}
+		consume(len, static_cast<const Scalar*>(xb), static_cast<const Scalar*>(yb));
+		if (nextLen > 0) {
+			gather_strided(nextLen, x + next * incx, incx, xb);
+			gather_strided(nextLen, y + next * incy, incy, yb);
+		}
+		k = next;
+		len = nextLen;
+	}
+}
+
+}} // namespace sw::hprblas
@@ -32,10 +32,11 @@ inline l1_norm(const Vector& v) {
 	return l1;
 }
 
-template<size_t nbits, size_t es>
+// L1-norm, posit specialized; the accumulation mode selects the quire or the binned accumulator
+template<accumulation Mode = accumulation::standard, size_t nbits, size_t es>
 sw::universal::posit<nbits, es> l1_norm(const mtl::dense_vector<sw::universal::posit<nbits, es> > & v) {
 	using Scalar = sw::universal::posit<nbits, es>;
-	sw::universal::quire<nbits, es> q(0);
+	reduction_accumulator_t<Mode, Scalar> q;
 	for (unsigned i = 0; i < size(v); ++i) {
 		q += abs(v[i]);
 	}
@@ -44,10 +45,10 @@ sw::universal::posit<nbits, es> l1_norm(const mtl::dense_vector<sw::universal::p
 	return l1;
 }
 
-template<size_t nbits, size_t es>
+template<accumulation Mode = accumulation::standard, size_t nbits, size_t es>
 sw::universal::posit<nbits, es> l1_norm(const mtl::dense2D<sw::universal::posit<nbits, es> > & M) {
 	using Scalar = sw::universal::posit<nbits, es>;
-	sw::universal::quire<nbits, es> q(0);
+	reduction_accumulator_t<Mode, Scalar> q;
 	for (unsigned i = 0; i < mtl::mat::num_rows(M); ++i) {
 		for (unsigned j = 0; j < mtl::mat::num_cols(M); ++j) {
 			q += abs(M[i][j]);
@@ -71,12 +72,12 @@ typename Vector::value_type l2_norm(const Vector& v) {
 }
 
 // L2-norm = Euclidean distance, posit specialized
-template<size_t nbits, size_t es>
+template<accumulation Mode = accumulation::standard, size_t nbits, size_t es>
 sw::universal::posit<nbits, es> l2_norm(const mtl::vec::dense_vector<sw::universal::posit<nbits, es> >& v) {
 	using Scalar = sw::universal::posit<nbits,es>;
-	sw::universal::quire<nbits, es> q(0);
+	reduction_accumulator_t<Mode, Scalar> q;
 	for (unsigned i = 0; i < size(v); ++i) {
-		q += sw::universal::quire_mul(v[i], v[i]);
+		quire_fma(q, v[i], v[i]);
 	}
 	Scalar l2 = Scalar(0);
 	convert(q.to_value(), l2);     // first rounding step of the l2-norm
@@ -95,6 +96,17 @@ inline linf_norm(const Vector& v) {
 	return linf;
 }
 
+// Linfinity-norm = max of the absolute value of each vector element, posit specialized
+// the element of largest magnitude is found by an integer search over the encodings; a NaR element yields NaR
+template<size_t nbits, size_t es>
+sw::universal::posit<nbits, es> linf_norm(const mtl::dense_vector<sw::universal::posit<nbits, es> >& v) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	size_t n = size(v);
+	if (n == 0) return Scalar(0);
+	Scalar linf = v[amax(n, v, 1)];
+	return (linf < 0 ? -linf : linf);
+}
+
 // Linfinity-norm = max of the absolute value of each matrix element
 template<typename Matrix>
 typename mtl::traits::enable_if_matrix<Matrix, typename mtl::RealMagnitude<typename mtl::Collection<Matrix>::value_type>::type>::type
@@ -125,17 +137,17 @@ typename Matrix::value_type frobenius_norm(const Matrix& M) {
 }
 
 // Frobenius-norm = sqrt of the sum of absolute squares, posit specialized for dense matrices
-template<size_t nbits, size_t es>
+template<accumulation Mode = accumulation::standard, size_t nbits, size_t es>
 sw::universal::posit<nbits, es> frobenius_norm(const mtl::dense2D<sw::universal::posit<nbits, es> >& M) {
+	using Scalar = sw::universal::posit<nbits, es>;
 	assert(mtl::mat::num_rows(M) == mtl::mat::num_cols(M)); // assuming squareness
 	int N = int(mtl::mat::num_cols(M));
-	sw::universal::quire<nbits, es> q(0);
+	reduction_accumulator_t<Mode, Scalar> q;
 	for (int i = 0; i < N; ++i) {
 		for (int j = 0; j < N; ++j) {
-			q += sw::universal::quire_mul(M[i][j], M[i][j]);
+			quire_fma(q, M[i][j], M[i][j]);
 		}
 	}
-	using Scalar = sw::universal::posit<nbits, es>;
 	Scalar frobenius = Scalar(0);
 	convert(q.to_value(), frobenius);     // first rounding step of the Frobenius-norm
 	return sqrt(frobenius);               // second rounding step of the Frobenius-norm
@@ -0,0 +1,154 @@
+#pragma once
+// thread_pool.hpp: minimal persistent thread pool to drive the parallel reproducible kernels
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ The thread pool executes a set of independent tasks, identified by an index in [0, nrTasks),
+ and blocks the caller until all tasks have completed. The caller participates in the work.
+
+ The reproducible kernels never depend on which thread executes which task: each task writes its
+ partial result (a quire) into a slot owned by that task index, and the caller merges the slots in
+ task order. As quire accumulation is exact, the merge order would not matter anyway.
+
+ Calling parallel_for from inside a task executes the nested tasks serially on the calling thread.
+ The first exception thrown by a task is rethrown in the caller, for example, a quire_exception.
+ */
+class thread_pool {
+public:
+	explicit thread_pool(size_t nrThreads = std::thread::hardware_concurrency()) : _stop(false), _generation(0), _busy(0), _nrTasks(0), _next(0) {
+		if (nrThreads == 0) nrThreads = 1;
+		// the calling thread is the first worker
+		for (size_t i = 1; i < nrThreads; ++i) {
+			_workers.emplace_back([this] { worker_loop(); });
+		}
+	}
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+	~thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_wakeup.notify_all();
+		for (auto& t : _workers) t.join();
+	}
+
+	// number of threads, including the calling thread, that execute tasks
+	size_t size() const { return _workers.size() + 1; }
+
+	// execute task(i) for all i in [0, nrTasks) and wait for completion
+	template<typename Task>
+	void parallel_for(size_t nrTasks, Task&& task) {
+		if (nrTasks == 0) return;
+		if (nrTasks == 1 || _workers.empty() || inside_task()) {
+			for (size_t i = 0; i < nrTasks; ++i) task(i);
+			return;
+		}
+		std::lock_guard<std::mutex> submission(_submit);  // one job in flight at a time
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_task = std::function<void(size_t)>(std::ref(task));
+			_nrTasks = nrTasks;
+			_next.store(0);
+			_error = nullptr;
+			_busy = _workers.size();
+			++_generation;
+		}
+		_wakeup.notify_all();
+		run_tasks();
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_done.wait(lock, [this] { return _busy == 0; });
+			_task = nullptr;
+		}
+		if (_error) std::rethrow_exception(_error);
+	}
+
+private:
+	static bool& inside_task() {
+		static thread_local bool flag = false;
+		return flag;
+	}
+	void run_tasks() {
+		inside_task() = true;
+		size_t i;
+		while ((i = _next.fetch_add(1)) < _nrTasks) {
+			try {
+				_task(i);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (!_error) _error = std::current_exception();
+			}
+		}
+		inside_task() = false;
+	}
+	void worker_loop() {
+		size_t seen = 0;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_wakeup.wait(lock, [&] { return _stop || _generation != seen; });
+				if (_stop) return;
+				seen = _generation;
+			}
+			run_tasks();
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (--_busy == 0) _done.notify_one();
+			}
+		}
+	}
+
+	std::vector<std::thread> _workers;
+	std::mutex _submit;
+	std::mutex _mutex;
+	std::condition_variable _wakeup;
+	std::condition_variable _done;
+	bool _stop;
+	size_t _generation;
+	size_t _busy;
+	std::function<void(size_t)> _task;
+	size_t _nrTasks;
+	std::atomic<size_t> _next;
+	std::exception_ptr _error;
+};
+
+// process-wide pool sized to the hardware concurrency
+inline thread_pool& default_thread_pool() {
+	static thread_pool pool;
+	return pool;
+}
+
+// number of blocks to split n work items into, given a thread count (0 selects the pool size)
+// and a minimum number of work items per block
+inline size_t nr_of_blocks(size_t n, size_t nrThreads, size_t grain) {
+	if (nrThreads == 0) nrThreads = default_thread_pool().size();
+	if (grain == 0) grain = 1;
+	size_t blocks = (n + grain - 1) / grain;
+	return std::max<size_t>(1, std::min(blocks, nrThreads));
+}
+
+// half-open range [first, last) of block b when n work items are split into nrBlocks blocks
+inline void block_range(size_t n, size_t nrBlocks, size_t b, size_t& first, size_t& last) {
+	size_t q = n / nrBlocks, r = n % nrBlocks;
+	first = b * q + std::min(b, r);
+	last = first + q + (b < r ? 1 : 0);
+}
+
+}} // namespace sw::hprblas
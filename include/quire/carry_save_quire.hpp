@@ -0,0 +1,162 @@
+#pragma once
+// carry_save_quire.hpp: quire engine that defers carry propagation
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <quire/posit_decode.hpp>
+#include <quire/limb_accumulator.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ carry_save_quire stores the quire as radix 2^32 digits held in signed 64-bit words. A product is
+ split into three 32-bit digits that are added to, or subtracted from, three adjacent words, so
+ consecutive accumulations do not depend on each other through a carry chain. The 31 bits of
+ headroom in each word absorb up to K accumulations; after K of them, and before the value is
+ read, the carries are resolved in a single pass.
+
+ to_value() resolves the carries into the limb_accumulator of the quire configuration and rounds
+ through the same path, so results are bitwise identical to the reference quire.
+ */
+template<size_t nbits, size_t es, size_t capacity, size_t K = (size_t(1) << 30)>
+class carry_save_quire {
+public:
+	static constexpr size_t fbits = nbits - 3 - es;
+	static constexpr size_t half_range = 2 * (nbits - 2) * (size_t(1) << es);   // maxpos^2 = 2^half_range
+	static constexpr size_t qbits = 2 * half_range + capacity;
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es, capacity>;
+	using Accumulator = limb_accumulator<(qbits + 1 + 63) / 64>;
+	// two digits above the accumulator width receive the upper digits of products near maxpos^2
+	static constexpr size_t nrDigits = 2 * Accumulator::nrLimbs + 2;
+	static constexpr uint64_t digit_mask = 0xFFFFFFFFull;
+	static_assert(2 * (fbits + 1) <= 64, "carry_save_quire requires the significand product to fit in 64 bits");
+	static_assert(((2 * half_range - 2 * fbits) >> 5) + 2 < nrDigits, "carry_save_quire product digits exceed the accumulator");
+	// normalized digits are below 2^32 and every accumulation adds less than 2^32 in magnitude
+	static_assert(K > 0 && K <= (size_t(1) << 30), "carry_save_quire must resolve carries at least every 2^30 accumulations");
+
+	carry_save_quire() { reset(); }
+	carry_save_quire(int i) { reset(); *this += Scalar(i); }
+	carry_save_quire(const Scalar& p) { reset(); *this += p; }
+
+	void reset() {
+		for (size_t i = 0; i < nrDigits; ++i) _digit[i] = 0;
+		_pending = 0;
+		_nar = false;
+	}
+	void clear() { reset(); }
+	bool iszero() const {
+		if (_nar) return false;
+		carry_save_quire q = *this;
+		q.normalize();
+		for (size_t i = 0; i < nrDigits; ++i) if (q._digit[i] != 0) return false;
+		return true;
+	}
+
+	// accumulate the exact product a * b
+	void fma(const Scalar& a, const Scalar& b) {
+		decoded_posit da = decode_posit(a);
+		decoded_posit db = decode_posit(b);
+		fma_decoded(da.significand, da.scale, (da.sign ? 1 : 0) | (da.nar ? 2 : 0), db.significand, db.scale, (db.sign ? 1 : 0) | (db.nar ? 2 : 0));
+	}
+	// accumulate the exact product of two decoded posits; flags bit 0 is the sign, bit 1 marks NaR
+	void fma_decoded(uint64_t sigA, int scaleA, unsigned flagsA, uint64_t sigB, int scaleB, unsigned flagsB) {
+		if ((flagsA | flagsB) & 2) { _nar = true; return; }
+		uint64_t p = sigA * sigB;
+		if (p == 0) return;
+		int shift = scaleA + scaleB - 2 * int(fbits) + int(half_range);
+		if (shift < 0) {     // only products of minpos-sized operands, whose low bits are zero
+			p >>= unsigned(-shift);
+			shift = 0;
+		}
+		size_t i = size_t(shift) >> 5;
+		unsigned offset = unsigned(shift & 31);
+		int64_t d0 = int64_t((p << offset) & digit_mask);
+		uint64_t upper = p >> (32 - offset);
+		int64_t d1 = int64_t(upper & digit_mask);
+		int64_t d2 = int64_t(upper >> 32);
+		if ((flagsA ^ flagsB) & 1) {
+			_digit[i] -= d0;
+			_digit[i + 1] -= d1;
+			_digit[i + 2] -= d2;
+		}
+		else {
+			_digit[i] += d0;
+			_digit[i + 1] += d1;
+			_digit[i + 2] += d2;
+		}
+		if (++_pending == K) normalize();
+	}
+	carry_save_quire& operator+=(const Scalar& p) { fma(p, Scalar(1)); return *this; }
+	carry_save_quire& operator+=(const carry_save_quire& rhs) {
+		carry_save_quire r = rhs;
+		r.normalize();
+		normalize();
+		for (size_t i = 0; i < nrDigits; ++i) _digit[i] += r._digit[i];
+		_pending = 1;
+		_nar |= rhs._nar;
+		return *this;
+	}
+	carry_save_quire& operator-=(const carry_save_quire& rhs) {
+		carry_save_quire r = rhs;
+		r.normalize();
+		normalize();
+		for (size_t i = 0; i < nrDigits; ++i) _digit[i] -= r._digit[i];
+		_pending = 1;
+		_nar |= rhs._nar;
+		return *this;
+	}
+
+	// resolve the deferred carries: every digit but the top one ends up in [0, 2^32)
+	void normalize() {
+		int64_t carry = 0;
+		for (size_t i = 0; i + 1 < nrDigits; ++i) {
+			int64_t v = _digit[i] + carry;
+			carry = v >> 32;                      // arithmetic shift: floor division by 2^32
+			_digit[i] = int64_t(uint64_t(v) & digit_mask);
+		}
+		_digit[nrDigits - 1] += carry;
+		_pending = 0;
+	}
+
+	// replace the content by a fixed-point image with bit 0 at weight 2^-half_range
+	void load(const Accumulator& acc, bool nar) {
+		for (size_t i = 0; i < Accumulator::nrLimbs; ++i) {
+			_digit[2 * i] = int64_t(acc.limb(i) & digit_mask);
+			_digit[2 * i + 1] = int64_t(acc.limb(i) >> 32);
+		}
+		// the top digit of a normalized quire is signed; the image is sign extended into the extra digits
+		_digit[2 * Accumulator::nrLimbs] = (acc.isneg() ? int64_t(digit_mask) : 0);
+		_digit[2 * Accumulator::nrLimbs + 1] = (acc.isneg() ? -1 : 0);
+		_pending = 0;
+		_nar = nar;
+	}
+
+	auto to_value() const {
+		carry_save_quire q = *this;
+		q.normalize();
+		// the value fits the accumulator, so its two's complement is the normalized digits modulo the accumulator width
+		Accumulator acc;
+		for (size_t i = 0; i < Accumulator::nrLimbs; ++i) {
+			acc.setlimb(i, (uint64_t(q._digit[2 * i]) & digit_mask) | (uint64_t(q._digit[2 * i + 1]) << 32));
+		}
+		return accumulator_to_value<Reference>(acc, int(half_range), _nar);
+	}
+
+private:
+	int64_t _digit[nrDigits];
+	size_t  _pending;     // accumulations since the last normalization
+	bool    _nar;
+};
+
+template<size_t nbits, size_t es, size_t capacity, size_t K>
+inline std::ostream& operator<<(std::ostream& ostr, const carry_save_quire<nbits, es, capacity, K>& q) {
+	return ostr << q.to_value();
+}
+
+}} // namespace sw::hprblas
@@ -0,0 +1,81 @@
+#pragma once
+// complex_quire.hpp: pair of quires accumulating exact complex products of posits
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <complex>
+#include <iostream>
+#include <quire/quire_traits.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ complex_quire holds the real and the imaginary part of a complex sum of products in two quires
+ of the fused kernels. A complex product a * b contributes the four exact real products
+ a.re * b.re - a.im * b.im and a.re * b.im + a.im * b.re, so a complex dot product rounds once per
+ component, where a complex multiply-accumulate in posit arithmetic rounds four times per term.
+ Negating a posit is exact, which turns the subtracted product into an accumulation.
+ */
+template<size_t nbits, size_t es, size_t capacity = 30>
+class complex_quire {
+public:
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Complex = std::complex<Scalar>;
+	using Quire = fused_quire_t<nbits, es, capacity>;
+
+	complex_quire() = default;
+
+	void reset() { _re.reset(); _im.reset(); }
+	void clear() { reset(); }
+	bool iszero() const { return _re.iszero() && _im.iszero(); }
+
+	// accumulate the exact product a * b
+	void fma(const Complex& a, const Complex& b) {
+		quire_fma(_re, a.real(), b.real());
+		quire_fma(_re, -a.imag(), b.imag());
+		quire_fma(_im, a.real(), b.imag());
+		quire_fma(_im, a.imag(), b.real());
+	}
+	// accumulate the exact product conj(a) * b
+	void fma_conj(const Complex& a, const Complex& b) {
+		quire_fma(_re, a.real(), b.real());
+		quire_fma(_re, a.imag(), b.imag());
+		quire_fma(_im, a.real(), b.imag());
+		quire_fma(_im, -a.imag(), b.real());
+	}
+	complex_quire& operator+=(const Complex& c) { _re += c.real(); _im += c.imag(); return *this; }
+	complex_quire& operator+=(const complex_quire& rhs) { _re += rhs._re; _im += rhs._im; return *this; }
+	complex_quire& operator-=(const complex_quire& rhs) { _re -= rhs._re; _im -= rhs._im; return *this; }
+
+	const Quire& real() const { return _re; }
+	const Quire& imag() const { return _im; }
+
+private:
+	Quire _re;
+	Quire _im;
+};
+
+// round the real and the imaginary part of a complex quire, one rounding step each
+template<size_t nbits, size_t es, size_t capacity>
+inline void convert(const complex_quire<nbits, es, capacity>& q, std::complex< sw::universal::posit<nbits, es> >& c) {
+	sw::universal::posit<nbits, es> re, im;
+	sw::universal::convert(q.real().to_value(), re);
+	sw::universal::convert(q.imag().to_value(), im);
+	c = std::complex< sw::universal::posit<nbits, es> >(re, im);
+}
+
+// quire_fma accumulates the exact complex product a * b into a complex quire
+template<size_t nbits, size_t es, size_t capacity>
+inline void quire_fma(complex_quire<nbits, es, capacity>& q, const std::complex< sw::universal::posit<nbits, es> >& a, const std::complex< sw::universal::posit<nbits, es> >& b) {
+	q.fma(a, b);
+}
+
+template<size_t nbits, size_t es, size_t capacity>
+inline std::ostream& operator<<(std::ostream& ostr, const complex_quire<nbits, es, capacity>& q) {
+	return ostr << '(' << q.real() << ',' << q.imag() << ')';
+}
+
+}} // namespace sw::hprblas
@@ -0,0 +1,157 @@
+#pragma once
+// limb_accumulator.hpp: fixed-point two's complement accumulator built from 64-bit limbs
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <type_traits>
+#include <utility>
+#include <universal/number/posit/posit.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ A limb_accumulator holds an nlimbs * 64-bit two's complement fixed-point number, least significant
+ limb first. It is the storage of the native quire implementations: bit 0 has weight 2^-half_range
+ of the quire configuration, so that every exact product of two posits is an integer multiple of it.
+ */
+template<size_t nlimbs>
+class limb_accumulator {
+public:
+	static constexpr size_t nrLimbs = nlimbs;
+	static constexpr size_t nrBits = 64 * nlimbs;
+
+	limb_accumulator() { clear(); }
+
+	void clear() { for (size_t i = 0; i < nlimbs; ++i) _limb[i] = 0; }
+	bool iszero() const {
+		uint64_t any = 0;
+		for (size_t i = 0; i < nlimbs; ++i) any |= _limb[i];
+		return any == 0;
+	}
+	bool isneg() const { return (_limb[nlimbs - 1] >> 63) != 0; }
+	uint64_t limb(size_t i) const { return _limb[i]; }
+	void setlimb(size_t i, uint64_t v) { _limb[i] = v; }
+	uint64_t* limbs() { return _limb; }
+	const uint64_t* limbs() const { return _limb; }
+
+	// add magnitude * 2^shift, with 0 <= shift < nrBits and magnitude < 2^64
+	void add(uint64_t magnitude, size_t shift) {
+		size_t i = shift >> 6;
+		unsigned offset = unsigned(shift & 63);
+		uint64_t lo = magnitude << offset;
+		uint64_t hi = (offset ? magnitude >> (64 - offset) : 0);
+		uint64_t s = _limb[i] + lo;
+		uint64_t carry = (s < lo);
+		_limb[i] = s;
+		for (++i; i < nlimbs; ++i) {
+			uint64_t t = hi + carry;
+			carry = (t < carry);          // hi + carry only wraps when hi == ~0
+			s = _limb[i] + t;
+			carry += (s < t);
+			_limb[i] = s;
+			hi = 0;
+			if (carry == 0) break;
+		}
+	}
+	// subtract magnitude * 2^shift, with 0 <= shift < nrBits and magnitude < 2^64
+	void sub(uint64_t magnitude, size_t shift) {
+		size_t i = shift >> 6;
+		unsigned offset = unsigned(shift & 63);
+		uint64_t lo = magnitude << offset;
+		uint64_t hi = (offset ? magnitude >> (64 - offset) : 0);
+		uint64_t borrow = (_limb[i] < lo);
+		_limb[i] -= lo;
+		for (++i; i < nlimbs; ++i) {
+			uint64_t t = hi + borrow;
+			borrow = (t < borrow);
+			uint64_t b = (_limb[i] < t);
+			_limb[i] -= t;
+			borrow += b;
+			hi = 0;
+			if (borrow == 0) break;
+		}
+	}
+	// add a signed magnitude * 2^shift; a negative shift drops bits that are known to be zero
+	void accumulate(bool negative, uint64_t magnitude, int shift) {
+		if (shift < 0) {
+			magnitude >>= unsigned(-shift);
+			shift = 0;
+		}
+		if (negative) sub(magnitude, size_t(shift)); else add(magnitude, size_t(shift));
+	}
+
+	limb_accumulator& operator+=(const limb_accumulator& rhs) {
+		uint64_t carry = 0;
+		for (size_t i = 0; i < nlimbs; ++i) {
+			uint64_t t = rhs._limb[i] + carry;
+			carry = (t < carry);
+			uint64_t s = _limb[i] + t;
+			carry += (s < t);
+			_limb[i] = s;
+		}
+		return *this;
+	}
+	limb_accumulator& operator-=(const limb_accumulator& rhs) {
+		uint64_t borrow = 0;
+		for (size_t i = 0; i < nlimbs; ++i) {
+			uint64_t t = rhs._limb[i] + borrow;
+			borrow = (t < borrow);
+			uint64_t b = (_limb[i] < t);
+			_limb[i] -= t;
+			borrow += b;
+		}
+		return *this;
+	}
+	void negate() {
+		uint64_t carry = 1;
+		for (size_t i = 0; i < nlimbs; ++i) {
+			uint64_t v = ~_limb[i] + carry;
+			carry = (carry && v == 0);
+			_limb[i] = v;
+		}
+	}
+	// position of the most significant set bit of a non-negative, non-zero accumulator
+	int msb() const {
+		for (size_t i = nlimbs; i-- > 0; ) {
+			if (_limb[i]) return int(64 * i) + 63 - std::countl_zero(_limb[i]);
+		}
+		return -1;
+	}
+	bool test(size_t bit) const { return ((_limb[bit >> 6] >> (bit & 63)) & 1) != 0; }
+
+private:
+	uint64_t _limb[nlimbs];
+};
+
+// Convert the content of a fixed-point accumulator, with bit 0 at weight 2^-half_range,
+// into the value type produced by Quire::to_value(), so that the final rounding step is
+// shared with the reference quire of the Universal library.
+template<typename Quire, size_t nlimbs>
+auto accumulator_to_value(const limb_accumulator<nlimbs>& acc, int half_range, bool nar = false) {
+	using Value = std::remove_cv_t<std::remove_reference_t<decltype(std::declval<const Quire&>().to_value())>>;
+	using Fraction = std::remove_cv_t<std::remove_reference_t<decltype(std::declval<const Value&>().fraction())>>;
+	Value v;
+	if (nar) {
+		v.set(false, 0, Fraction(), false, false, true);
+		return v;
+	}
+	if (acc.iszero()) return v;
+	limb_accumulator<nlimbs> magnitude = acc;
+	bool negative = magnitude.isneg();
+	if (negative) magnitude.negate();
+	int msb = magnitude.msb();
+	Fraction fraction;
+	int fbits = int(fraction.size());
+	for (int i = msb - 1, f = fbits - 1; i >= 0 && f >= 0; --i, --f) {
+		if (magnitude.test(size_t(i))) fraction.set(size_t(f));
+	}
+	v.set(negative, msb - half_range, fraction, false, false);
+	return v;
+}
+
+}} // namespace sw::hprblas
@@ -0,0 +1,165 @@
+#pragma once
+// limb_quire.hpp: quire engine accumulating decoded posit products into 64-bit limbs
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <quire/posit_decode.hpp>
+#include <quire/limb_accumulator.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ limb_quire accumulates exact posit products in a limb_accumulator. Operands are either posits,
+ decoded on the fly, or entries of a decoded posit panel, in which case the inner loop is a
+ single integer multiply and a shifted add.
+
+ The product of two significands has 2 * (fbits + 1) bits and must fit a 64-bit integer,
+ which holds for all posit configurations with nbits <= 32.
+ */
+template<size_t nbits, size_t es, size_t capacity>
+class limb_quire {
+public:
+	static constexpr size_t fbits = nbits - 3 - es;
+	static constexpr size_t half_range = 2 * (nbits - 2) * (size_t(1) << es);   // maxpos^2 = 2^half_range
+	static constexpr size_t qbits = 2 * half_range + capacity;
+	static_assert(2 * (fbits + 1) <= 64, "limb_quire requires the significand product to fit in 64 bits");
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es, capacity>;
+	using Accumulator = limb_accumulator<(qbits + 1 + 63) / 64>;
+
+	limb_quire() : _nar(false) {}
+	limb_quire(int i) : _nar(false) { *this += Scalar(i); }
+	limb_quire(const Scalar& p) : _nar(false) { *this += p; }
+
+	void reset() { _acc.clear(); _nar = false; }
+	void clear() { reset(); }
+	bool iszero() const { return _acc.iszero() && !_nar; }
+
+	// accumulate the exact product a * b
+	void fma(const Scalar& a, const Scalar& b) {
+		decoded_posit da = decode_posit(a);
+		decoded_posit db = decode_posit(b);
+		if (da.nar || db.nar) { _nar = true; return; }
+		if (da.significand == 0 || db.significand == 0) return;
+		fma_decoded(da.significand, da.scale, da.sign ? 1 : 0, db.significand, db.scale, db.sign ? 1 : 0);
+	}
+	// accumulate the exact product of two decoded posits; flags bit 0 is the sign, bit 1 marks NaR
+	void fma_decoded(uint64_t sigA, int scaleA, unsigned flagsA, uint64_t sigB, int scaleB, unsigned flagsB) {
+		if ((flagsA | flagsB) & 2) { _nar = true; return; }
+		uint64_t p = sigA * sigB;
+		if (p == 0) return;
+		int shift = scaleA + scaleB - 2 * int(fbits) + int(half_range);
+		_acc.accumulate(((flagsA ^ flagsB) & 1) != 0, p, shift);
+	}
+	limb_quire& operator+=(const Scalar& p) { fma(p, Scalar(1)); return *this; }
+	limb_quire& operator+=(const limb_quire& rhs) { _acc += rhs._acc; _nar |= rhs._nar; return *this; }
+	limb_quire& operator-=(const limb_quire& rhs) { _acc -= rhs._acc; _nar |= rhs._nar; return *this; }
+
+	// replace the content by a fixed-point image with bit 0 at weight 2^-half_range
+	void load(const Accumulator& acc, bool nar) { _acc = acc; _nar = nar; }
+
+	auto to_value() const { return accumulator_to_value<Reference>(_acc, int(half_range), _nar); }
+
+private:
+	Accumulator _acc;
+	bool        _nar;
+};
+
+/*
+ posit<32,2> specialization: the product of two 28-bit significands has at most 56 bits and
+ lands in a window of two adjacent limbs. The window is added as a single 128-bit integer and
+ the carry, or borrow, ripples into the limbs above only when the window overflows.
+ */
+template<size_t capacity>
+class limb_quire<32, 2, capacity> {
+public:
+	static constexpr size_t nbits = 32;
+	static constexpr size_t es = 2;
+	static constexpr size_t fbits = nbits - 3 - es;
+	static constexpr size_t half_range = 2 * (nbits - 2) * (size_t(1) << es);   // maxpos^2 = 2^240
+	static constexpr size_t qbits = 2 * half_range + capacity;
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es, capacity>;
+	using Accumulator = limb_accumulator<(qbits + 1 + 63) / 64>;
+	static constexpr size_t nlimbs = Accumulator::nrLimbs;
+	// maxpos^2 is placed at the largest shift, 2 * half_range - 2 * fbits; its window must end within the accumulator
+	static_assert(((2 * half_range - 2 * fbits) >> 6) + 1 < nlimbs, "limb_quire<32,2> product window exceeds the accumulator");
+
+	limb_quire() : _nar(false) {}
+	limb_quire(int i) : _nar(false) { *this += Scalar(i); }
+	limb_quire(const Scalar& p) : _nar(false) { *this += p; }
+
+	void reset() { _acc.clear(); _nar = false; }
+	void clear() { reset(); }
+	bool iszero() const { return _acc.iszero() && !_nar; }
+
+	// accumulate the exact product a * b
+	void fma(const Scalar& a, const Scalar& b) {
+		decoded_posit da = decode_posit(a);
+		decoded_posit db = decode_posit(b);
+		fma_decoded(da.significand, da.scale, (da.sign ? 1 : 0) | (da.nar ? 2 : 0), db.significand, db.scale, (db.sign ? 1 : 0) | (db.nar ? 2 : 0));
+	}
+	// accumulate the exact product of two decoded posits; flags bit 0 is the sign, bit 1 marks NaR
+	void fma_decoded(uint64_t sigA, int scaleA, unsigned flagsA, uint64_t sigB, int scaleB, unsigned flagsB) {
+		if ((flagsA | flagsB) & 2) { _nar = true; return; }
+		uint64_t p = sigA * sigB;
+		if (p == 0) return;
+		int shift = scaleA + scaleB - 2 * int(fbits) + int(half_range);
+		if (shift < 0) {     // only products of minpos-sized operands, whose low bits are zero
+			p >>= unsigned(-shift);
+			shift = 0;
+		}
+		bool negative = ((flagsA ^ flagsB) & 1) != 0;
+#if defined(__SIZEOF_INT128__)
+		uint64_t* limb = _acc.limbs();
+		size_t i = size_t(shift) >> 6;
+		unsigned __int128 m = static_cast<unsigned __int128>(p) << (shift & 63);
+		unsigned __int128 w = (static_cast<unsigned __int128>(limb[i + 1]) << 64) | limb[i];
+		bool carry;
+		if (negative) {
+			unsigned __int128 d = w - m;
+			carry = (d > w);
+			w = d;
+		}
+		else {
+			unsigned __int128 s = w + m;
+			carry = (s < m);
+			w = s;
+		}
+		limb[i] = uint64_t(w);
+		limb[i + 1] = uint64_t(w >> 64);
+		if (negative) {
+			for (i += 2; carry && i < nlimbs; ++i) carry = (limb[i]-- == 0);
+		}
+		else {
+			for (i += 2; carry && i < nlimbs; ++i) carry = (++limb[i] == 0);
+		}
+#else
+		_acc.accumulate(negative, p, shift);
+#endif
+	}
+	limb_quire& operator+=(const Scalar& p) { fma(p, Scalar(1)); return *this; }
+	limb_quire& operator+=(const limb_quire& rhs) { _acc += rhs._acc; _nar |= rhs._nar; return *this; }
+	limb_quire& operator-=(const limb_quire& rhs) { _acc -= rhs._acc; _nar |= rhs._nar; return *this; }
+
+	// replace the content by a fixed-point image with bit 0 at weight 2^-half_range
+	void load(const Accumulator& acc, bool nar) { _acc = acc; _nar = nar; }
+
+	auto to_value() const { return accumulator_to_value<Reference>(_acc, int(half_range), _nar); }
+
+private:
+	Accumulator _acc;
+	bool        _nar;
+};
+
+template<size_t nbits, size_t es, size_t capacity>
+inline std::ostream& operator<<(std::ostream& ostr, const limb_quire<nbits, es, capacity>& q) {
+	return ostr << q.to_value();
+}
+
+}} // namespace sw::hprblas
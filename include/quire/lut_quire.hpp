@@ -0,0 +1,168 @@
+#pragma once
+// lut_quire.hpp: table-driven quire engines for small posit configurations
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <iostream>
+#include <quire/posit_decode.hpp>
+#include <quire/limb_accumulator.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ For small posits the cost of quire_mul is dominated by decoding the operands and multiplying
+ the fractions in software. The lut_quire engines replace that with table lookups:
+
+   posit<8,0>  : a 256x256 table of exact products, stored as fixed-point integers with weight
+                 2^-half_range, accumulated into a single 64-bit integer
+   posit<16,1> : a 65536-entry table of decoded (sign, scale, significand) values; the product is
+                 a 26-bit integer multiply accumulated into a limb_accumulator
+
+ The engines expose the subset of the quire interface used by the fused kernels, and to_value()
+ yields the same value type as sw::universal::quire, so the rounding step is shared with the
+ reference quire and results are bitwise identical.
+ */
+template<size_t nbits, size_t es, size_t capacity>
+class lut_quire;
+
+// posit<8,0>: exact product table
+template<size_t capacity>
+class lut_quire<8, 0, capacity> {
+public:
+	static constexpr size_t nbits = 8;
+	static constexpr size_t es = 0;
+	static constexpr size_t half_range = 2 * (nbits - 2);   // minpos^2 = 2^-12, maxpos^2 = 2^12
+	static constexpr size_t qbits = 2 * half_range + capacity;
+	static_assert(qbits < 64, "lut_quire<8,0> capacity must fit a 64-bit accumulator");
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es, capacity>;
+
+	lut_quire() : _table(product_table()), _acc(0), _nar(false) {}
+	lut_quire(int i) : _table(product_table()), _acc(0), _nar(false) { *this += Scalar(i); }
+	lut_quire(const Scalar& p) : _table(product_table()), _acc(0), _nar(false) { *this += p; }
+
+	void reset() { _acc = 0; _nar = false; }
+	void clear() { reset(); }
+	bool iszero() const { return _acc == 0 && !_nar; }
+
+	// accumulate the exact product a * b
+	void fma(const Scalar& a, const Scalar& b) { fma(uint8_t(posit_bits(a)), uint8_t(posit_bits(b))); }
+	void fma(uint8_t a, uint8_t b) {
+		if (a == 0x80 || b == 0x80) _nar = true; else _acc += _table[(size_t(a) << 8) | b];
+	}
+	lut_quire& operator+=(const Scalar& p) { fma(uint8_t(posit_bits(p)), uint8_t(0x40)); return *this; }  // p * 1
+	lut_quire& operator+=(const lut_quire& rhs) { _acc += rhs._acc; _nar |= rhs._nar; return *this; }
+	lut_quire& operator-=(const lut_quire& rhs) { _acc -= rhs._acc; _nar |= rhs._nar; return *this; }
+
+	// replace the content by a fixed-point image with bit 0 at weight 2^-half_range
+	void load(const limb_accumulator<1>& acc, bool nar) { _acc = int64_t(acc.limb(0)); _nar = nar; }
+
+	auto to_value() const {
+		limb_accumulator<1> acc;
+		acc.setlimb(0, uint64_t(_acc));
+		return accumulator_to_value<Reference>(acc, int(half_range), _nar);
+	}
+
+	// product table indexed by (a << 8) | b, in units of 2^-half_range
+	static const int32_t* product_table() {
+		static const std::vector<int32_t> table = [] {
+			std::vector<int32_t> t(size_t(1) << 16);
+			for (size_t a = 0; a < 256; ++a) {
+				decoded_posit da = decode_posit<nbits, es>(a);
+				for (size_t b = 0; b < 256; ++b) {
+					decoded_posit db = decode_posit<nbits, es>(b);
+					int shift = da.scale + db.scale - 2 * int(nbits - 3 - es) + int(half_range);
+					uint64_t p = da.significand * db.significand;
+					p = (shift < 0 ? p >> -shift : p << shift);
+					t[(a << 8) | b] = (da.sign != db.sign ? -int32_t(p) : int32_t(p));
+				}
+			}
+			return t;
+		}();
+		return table.data();
+	}
+
+private:
+	const int32_t* _table;
+	int64_t _acc;
+	bool    _nar;
+};
+
+// posit<16,1>: decode table
+template<size_t capacity>
+class lut_quire<16, 1, capacity> {
+public:
+	static constexpr size_t nbits = 16;
+	static constexpr size_t es = 1;
+	static constexpr size_t fbits = nbits - 3 - es;
+	static constexpr size_t half_range = 2 * (nbits - 2) * (size_t(1) << es);   // maxpos^2 = 2^56
+	static constexpr size_t qbits = 2 * half_range + capacity;
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es, capacity>;
+	using Accumulator = limb_accumulator<(qbits + 1 + 63) / 64>;
+
+	// decoded posit<16,1>: flags bit 0 is the sign, bit 1 marks NaR
+	struct entry {
+		uint16_t significand;
+		int8_t   scale;
+		uint8_t  flags;
+	};
+
+	lut_quire() : _table(decode_table()), _nar(false) {}
+	lut_quire(int i) : _table(decode_table()), _nar(false) { *this += Scalar(i); }
+	lut_quire(const Scalar& p) : _table(decode_table()), _nar(false) { *this += p; }
+
+	void reset() { _acc.clear(); _nar = false; }
+	void clear() { reset(); }
+	bool iszero() const { return _acc.iszero() && !_nar; }
+
+	// accumulate the exact product a * b
+	void fma(const Scalar& a, const Scalar& b) { fma(uint16_t(posit_bits(a)), uint16_t(posit_bits(b))); }
+	void fma(uint16_t a, uint16_t b) {
+		const entry& da = _table[a];
+		const entry& db = _table[b];
+		if ((da.flags | db.flags) & 2) { _nar = true; return; }
+		uint64_t p = uint64_t(da.significand) * db.significand;
+		int shift = int(da.scale) + int(db.scale) - 2 * int(fbits) + int(half_range);
+		_acc.accumulate(((da.flags ^ db.flags) & 1) != 0, p, shift);
+	}
+	lut_quire& operator+=(const Scalar& p) { fma(uint16_t(posit_bits(p)), uint16_t(0x4000)); return *this; }  // p * 1
+	lut_quire& operator+=(const lut_quire& rhs) { _acc += rhs._acc; _nar |= rhs._nar; return *this; }
+	lut_quire& operator-=(const lut_quire& rhs) { _acc -= rhs._acc; _nar |= rhs._nar; return *this; }
+
+	// replace the content by a fixed-point image with bit 0 at weight 2^-half_range
+	void load(const Accumulator& acc, bool nar) { _acc = acc; _nar = nar; }
+
+	auto to_value() const { return accumulator_to_value<Reference>(_acc, int(half_range), _nar); }
+
+	static const entry* decode_table() {
+		static const std::vector<entry> table = [] {
+			std::vector<entry> t(size_t(1) << 16);
+			for (size_t i = 0; i < t.size(); ++i) {
+				decoded_posit d = decode_posit<nbits, es>(i);
+				t[i].significand = uint16_t(d.significand);
+				t[i].scale = int8_t(d.scale);
+				t[i].flags = uint8_t((d.sign ? 1 : 0) | (d.nar ? 2 : 0));
+			}
+			return t;
+		}();
+		return table.data();
+	}
+
+private:
+	const entry* _table;
+	Accumulator  _acc;
+	bool        _nar;
+};
+
+template<size_t nbits, size_t es, size_t capacity>
+inline std::ostream& operator<<(std::ostream& ostr, const lut_quire<nbits, es, capacity>& q) {
+	return ostr << q.to_value();
+}
+
+}} // namespace sw::hprblas
@@ -0,0 +1,75 @@
+#pragma once
+// mixed_quire.hpp: quire engine accumulating exact products of two different posit configurations
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <quire/posit_decode.hpp>
+#include <quire/limb_accumulator.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ mixed_quire has the geometry of sw::universal::quire<nbits, es, capacity>, but accumulates the
+ exact product of a posit<nbitsA, esA> and a posit<nbitsB, esB>, for instance a posit<8,0> weight
+ and a posit<16,1> activation, without converting either operand to posit<nbits, es>.
+
+ The product of the two operands is a multiple of minposA * minposB and at most maxposA * maxposB,
+ so the quire holds it exactly when (nbitsA - 2) * 2^esA + (nbitsB - 2) * 2^esB <= half_range;
+ the significand product must fit a 64-bit integer. to_value() yields the value type of the
+ reference quire, so the rounding step is shared with it.
+ */
+template<size_t nbits, size_t es, size_t capacity = 30>
+class mixed_quire {
+public:
+	static constexpr size_t half_range = 2 * (nbits - 2) * (size_t(1) << es);   // maxpos^2 = 2^half_range
+	static constexpr size_t qbits = 2 * half_range + capacity;
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Reference = sw::universal::quire<nbits, es, capacity>;
+	using Accumulator = limb_accumulator<(qbits + 1 + 63) / 64>;
+
+	// true when the exact products of posit<nbitsA, esA> and posit<nbitsB, esB> fit the quire
+	template<size_t nbitsA, size_t esA, size_t nbitsB, size_t esB>
+	static constexpr bool holds_products =
+		(nbitsA - 2) * (size_t(1) << esA) + (nbitsB - 2) * (size_t(1) << esB) <= half_range &&
+		(nbitsA - 2 - esA) + (nbitsB - 2 - esB) <= 64;
+
+	mixed_quire() : _nar(false) {}
+
+	void reset() { _acc.clear(); _nar = false; }
+	void clear() { reset(); }
+	bool iszero() const { return _acc.iszero() && !_nar; }
+
+	// accumulate the exact product a * b
+	template<size_t nbitsA, size_t esA, size_t nbitsB, size_t esB>
+	void fma(const sw::universal::posit<nbitsA, esA>& a, const sw::universal::posit<nbitsB, esB>& b) {
+		static_assert(holds_products<nbitsA, esA, nbitsB, esB>, "mixed_quire configuration cannot hold the products of these posit configurations");
+		decoded_posit da = decode_posit(a);
+		decoded_posit db = decode_posit(b);
+		if (da.nar || db.nar) { _nar = true; return; }
+		uint64_t p = da.significand * db.significand;
+		if (p == 0) return;
+		int shift = da.scale - int(nbitsA - 3 - esA) + db.scale - int(nbitsB - 3 - esB) + int(half_range);
+		_acc.accumulate(da.sign != db.sign, p, shift);
+	}
+	mixed_quire& operator+=(const Scalar& p) { fma(p, Scalar(1)); return *this; }
+	mixed_quire& operator+=(const mixed_quire& rhs) { _acc += rhs._acc; _nar |= rhs._nar; return *this; }
+	mixed_quire& operator-=(const mixed_quire& rhs) { _acc -= rhs._acc; _nar |= rhs._nar; return *this; }
+
+	auto to_value() const { return accumulator_to_value<Reference>(_acc, int(half_range), _nar); }
+
+private:
+	Accumulator _acc;
+	bool        _nar;
+};
+
+template<size_t nbits, size_t es, size_t capacity>
+inline std::ostream& operator<<(std::ostream& ostr, const mixed_quire<nbits, es, capacity>& q) {
+	return ostr << q.to_value();
+}
+
+}} // namespace sw::hprblas
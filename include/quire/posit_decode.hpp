@@ -0,0 +1,81 @@
+#pragma once
+// posit_decode.hpp: decode posit bit patterns into sign, scale, and significand
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <universal/number/posit/posit.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ The fused kernels accumulate exact products into a fixed-point accumulator. The decoded form
+ of a posit<nbits, es> is (sign, scale, significand), where the significand carries the hidden bit
+ at position fbits = nbits - 3 - es, the largest number of fraction bits of the configuration:
+
+     value = (-1)^sign * significand * 2^(scale - fbits)
+
+ Zero decodes to a significand of 0, NaR sets the nar flag.
+ This decoder is restricted to posits with nbits <= 64.
+ */
+struct decoded_posit {
+	uint64_t significand;
+	int      scale;
+	bool     sign;
+	bool     nar;
+};
+
+// raw bit pattern of a posit, right-aligned in a 64-bit word
+template<size_t nbits, size_t es>
+inline uint64_t posit_bits(const sw::universal::posit<nbits, es>& p) {
+	static_assert(nbits <= 64, "posit_bits requires nbits <= 64");
+	return p.get().to_ullong();
+}
+
+// decode the bit pattern of a posit<nbits, es>
+template<size_t nbits, size_t es>
+inline decoded_posit decode_posit(uint64_t bits) {
+	static_assert(nbits >= 3 + es && nbits <= 64, "decode_posit requires 3 + es <= nbits <= 64");
+	constexpr size_t fbits = nbits - 3 - es;
+	constexpr uint64_t mask = (nbits == 64 ? ~uint64_t(0) : ((uint64_t(1) << nbits) - 1));
+	constexpr uint64_t sign_mask = uint64_t(1) << (nbits - 1);
+	decoded_posit d{ 0, 0, false, false };
+	bits &= mask;
+	if (bits == 0) return d;
+	if (bits == sign_mask) { d.nar = true; return d; }
+	d.sign = (bits & sign_mask) != 0;
+	if (d.sign) bits = (~bits + 1) & mask;
+	// left-align the bits that follow the sign bit
+	uint64_t x = bits << (65 - nbits);
+	int run, k;
+	if (x >> 63) {
+		run = std::countl_zero(~x);
+		k = run - 1;
+	}
+	else {
+		run = std::countl_zero(x);
+		k = -run;
+	}
+	x = (x << run) << 1;                  // strip regime and its terminating bit
+	int e = 0;
+	if constexpr (es > 0) {
+		e = int(x >> (64 - es));          // truncated exponent bits read as 0
+		x <<= es;
+	}
+	uint64_t fraction = 0;
+	if constexpr (fbits > 0) fraction = x >> (64 - fbits);
+	d.significand = (uint64_t(1) << fbits) | fraction;
+	d.scale = k * (1 << es) + e;
+	return d;
+}
+
+template<size_t nbits, size_t es>
+inline decoded_posit decode_posit(const sw::universal::posit<nbits, es>& p) {
+	return decode_posit<nbits, es>(posit_bits(p));
+}
+
+}} // namespace sw::hprblas
@@ -0,0 +1,197 @@
+#pragma once
+// posit_panel.hpp: bulk decoding of posit bit patterns into structure-of-arrays panels
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#include <quire/posit_decode.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ The fused kernels decode every operand of every product. When an operand is reused, as the
+ vector x in a matrix-vector product or the columns of B in a matrix-matrix product, decoding
+ it once into a panel removes that work from the inner loop.
+
+ A panel stores decoded posits as three arrays:
+     significand : hidden bit at position fbits = nbits - 3 - es, 0 for zero and NaR
+     scale       : regime and exponent combined, value = significand * 2^(scale - fbits)
+     flags       : bit 0 is the sign, bit 1 marks NaR
+
+ Bit patterns are decoded eight (AVX2) or sixteen (AVX-512) at a time in 32-bit lanes,
+ with a scalar fallback, so panels are supported for posits with nbits <= 32.
+ */
+
+// storage type of the bit pattern of a posit<nbits, es> with nbits <= 32
+template<size_t nbits>
+using posit_bits_t = std::conditional_t<(nbits <= 8), uint8_t, std::conditional_t<(nbits <= 16), uint16_t, uint32_t> >;
+
+namespace detail {
+
+template<size_t nbits, size_t es>
+inline void decode_posit_bits_scalar(size_t n, const posit_bits_t<nbits>* bits, uint32_t* significand, int32_t* scale, uint8_t* flags) {
+	for (size_t i = 0; i < n; ++i) {
+		decoded_posit d = decode_posit<nbits, es>(uint64_t(bits[i]));
+		significand[i] = uint32_t(d.significand);
+		scale[i] = d.scale;
+		flags[i] = uint8_t((d.sign ? 1 : 0) | (d.nar ? 2 : 0));
+	}
+}
+
+#if defined(__AVX512F__) && defined(__AVX512CD__)
+// decode sixteen posit bit patterns, zero-extended into 32-bit lanes
+template<size_t nbits, size_t es>
+inline void decode16_avx512(__m512i b, uint32_t* significand, int32_t* scale, uint8_t* flags) {
+	constexpr unsigned fbits = unsigned(nbits - 3 - es);
+	constexpr uint32_t mask = (nbits == 32 ? 0xFFFFFFFFu : ((1u << nbits) - 1u));
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i signbit = _mm512_set1_epi32(int(1u << (nbits - 1)));
+	__mmask16 isneg = _mm512_test_epi32_mask(b, signbit);
+	__mmask16 iszero = _mm512_cmpeq_epi32_mask(b, zero);
+	__mmask16 isnar = _mm512_cmpeq_epi32_mask(b, signbit);
+	__m512i magnitude = _mm512_and_si512(_mm512_sub_epi32(zero, b), _mm512_set1_epi32(int(mask)));
+	b = _mm512_mask_blend_epi32(isneg, b, magnitude);
+	__m512i x = _mm512_slli_epi32(b, 33 - unsigned(nbits));        // left-align the bits after the sign
+	__m512i r0 = _mm512_srai_epi32(x, 31);                          // all ones when the regime is a run of 1s
+	__m512i run = _mm512_lzcnt_epi32(_mm512_xor_si512(x, r0));
+	__m512i k = _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(r0, zero), _mm512_sub_epi32(zero, run), _mm512_sub_epi32(run, _mm512_set1_epi32(1)));
+	x = _mm512_sllv_epi32(x, _mm512_add_epi32(run, _mm512_set1_epi32(1)));   // strip regime and terminating bit
+	__m512i e = zero;
+	if constexpr (es > 0) {
+		e = _mm512_srli_epi32(x, 32 - unsigned(es));
+		x = _mm512_slli_epi32(x, unsigned(es));
+	}
+	__m512i sig = _mm512_set1_epi32(int(1u << fbits));
+	if constexpr (fbits > 0) sig = _mm512_or_si512(sig, _mm512_srli_epi32(x, 32 - fbits));
+	__m512i sc = _mm512_add_epi32(_mm512_slli_epi32(k, unsigned(es)), e);
+	__mmask16 special = iszero | isnar;
+	_mm512_storeu_si512(significand, _mm512_maskz_mov_epi32(__mmask16(~special), sig));
+	_mm512_storeu_si512(scale, _mm512_maskz_mov_epi32(__mmask16(~special), sc));
+	unsigned s = unsigned(isneg & ~isnar), r = unsigned(isnar);
+	for (unsigned l = 0; l < 16; ++l) flags[l] = uint8_t(((s >> l) & 1) | (((r >> l) & 1) << 1));
+}
+#endif
+
+#if defined(__AVX2__)
+// decode eight posit bit patterns, zero-extended into 32-bit lanes
+template<size_t nbits, size_t es>
+inline void decode8_avx2(__m256i b, uint32_t* significand, int32_t* scale, uint8_t* flags) {
+	constexpr unsigned fbits = unsigned(nbits - 3 - es);
+	constexpr uint32_t mask = (nbits == 32 ? 0xFFFFFFFFu : ((1u << nbits) - 1u));
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i signbit = _mm256_set1_epi32(int(1u << (nbits - 1)));
+	__m256i isneg = _mm256_cmpeq_epi32(_mm256_and_si256(b, signbit), signbit);
+	__m256i isnar = _mm256_cmpeq_epi32(b, signbit);
+	__m256i special = _mm256_or_si256(_mm256_cmpeq_epi32(b, zero), isnar);
+	__m256i magnitude = _mm256_and_si256(_mm256_sub_epi32(zero, b), _mm256_set1_epi32(int(mask)));
+	b = _mm256_blendv_epi8(b, magnitude, isneg);
+	__m256i x = _mm256_slli_epi32(b, 33 - int(nbits));             // left-align the bits after the sign
+	__m256i r0 = _mm256_srai_epi32(x, 31);                          // all ones when the regime is a run of 1s
+	__m256i y = _mm256_xor_si256(x, r0);                            // the regime run is now a run of 0s, bit 31 is clear
+	// count leading zeros through the exponent of a float conversion: clearing the bit below the
+	// leading one guarantees the conversion cannot round up into the next binade
+	__m256i w = _mm256_andnot_si256(_mm256_srli_epi32(y, 1), y);
+	__m256i msb = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(w)), 23), _mm256_set1_epi32(127));
+	__m256i run = _mm256_sub_epi32(_mm256_set1_epi32(31), msb);
+	__m256i k = _mm256_blendv_epi8(_mm256_sub_epi32(zero, run), _mm256_sub_epi32(run, one), r0);
+	x = _mm256_sllv_epi32(x, _mm256_add_epi32(run, one));          // strip regime and terminating bit
+	__m256i e = zero;
+	if constexpr (es > 0) {
+		e = _mm256_srli_epi32(x, 32 - int(es));
+		x = _mm256_slli_epi32(x, int(es));
+	}
+	__m256i sig = _mm256_set1_epi32(int(1u << fbits));
+	if constexpr (fbits > 0) sig = _mm256_or_si256(sig, _mm256_srli_epi32(x, 32 - int(fbits)));
+	__m256i sc = _mm256_add_epi32(_mm256_slli_epi32(k, int(es)), e);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(significand), _mm256_andnot_si256(special, sig));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(scale), _mm256_andnot_si256(special, sc));
+	unsigned s = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(isnar, isneg))));
+	unsigned r = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(isnar)));
+	for (unsigned l = 0; l < 8; ++l) flags[l] = uint8_t(((s >> l) & 1) | (((r >> l) & 1) << 1));
+}
+#endif
+
+} // namespace detail
+
+// decode n posit bit patterns into the significand, scale, and flags arrays
+template<size_t nbits, size_t es>
+inline void decode_posit_bits(size_t n, const posit_bits_t<nbits>* bits, uint32_t* significand, int32_t* scale, uint8_t* flags) {
+	static_assert(nbits <= 32, "decoded posit panels require nbits <= 32");
+	size_t i = 0;
+	if constexpr (nbits > 8) {
+#if defined(__AVX512F__) && defined(__AVX512CD__)
+		for (; i + 16 <= n; i += 16) {
+			__m512i b;
+			if constexpr (nbits <= 16) {
+				b = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + i)));
+			}
+			else {
+				b = _mm512_loadu_si512(bits + i);
+			}
+			detail::decode16_avx512<nbits, es>(b, significand + i, scale + i, flags + i);
+		}
+#endif
+#if defined(__AVX2__)
+		for (; i + 8 <= n; i += 8) {
+			__m256i b;
+			if constexpr (nbits <= 16) {
+				b = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + i)));
+			}
+			else {
+				b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + i));
+			}
+			detail::decode8_avx2<nbits, es>(b, significand + i, scale + i, flags + i);
+		}
+#endif
+	}
+	detail::decode_posit_bits_scalar<nbits, es>(n - i, bits + i, significand + i, scale + i, flags + i);
+}
+
+// structure-of-arrays panel of decoded posits
+template<size_t nbits, size_t es>
+class posit_panel {
+public:
+	static_assert(nbits <= 32, "decoded posit panels require nbits <= 32");
+	static constexpr size_t fbits = nbits - 3 - es;
+	using Scalar = sw::universal::posit<nbits, es>;
+	using bits_type = posit_bits_t<nbits>;
+
+	posit_panel(size_t n = 0) { resize(n); }
+	posit_panel(size_t n, const Scalar* x, size_t incx = 1) { resize(n); decode(0, n, x, incx); }
+
+	void resize(size_t n) {
+		_bits.resize(n);
+		_significand.resize(n);
+		_scale.resize(n);
+		_flags.resize(n);
+	}
+	size_t size() const { return _significand.size(); }
+
+	// decode n posits, read with stride incx, into the panel starting at offset
+	void decode(size_t offset, size_t n, const Scalar* x, size_t incx = 1) {
+		bits_type* bits = _bits.data() + offset;
+		for (size_t i = 0; i < n; ++i) bits[i] = bits_type(posit_bits(x[i * incx]));
+		decode_posit_bits<nbits, es>(n, bits, _significand.data() + offset, _scale.data() + offset, _flags.data() + offset);
+	}
+
+	const uint32_t* significand() const { return _significand.data(); }
+	const int32_t* scale() const { return _scale.data(); }
+	const uint8_t* flags() const { return _flags.data(); }
+
+private:
+	std::vector<bits_type> _bits;   // staging buffer of raw bit patterns
+	std::vector<uint32_t>  _significand;
+	std::vector<int32_t>   _scale;
+	std::vector<uint8_t>   _flags;
+};
+
+}} // namespace sw::hprblas
@@ -0,0 +1,313 @@
+#pragma once
+// quire_serialization.hpp: compact binary images of quires and exact reductions across processes
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <cerrno>
+#define HPRBLAS_POSIX_QUIRE_TRANSPORT 1
+#endif
+#include <quire/limb_accumulator.hpp>
+#include <quire/quire_traits.hpp>
+
+namespace sw {
+namespace hprblas {
+
+/*
+ A quire<nbits, es, capacity> is a two's complement fixed-point number with bit 0 at weight
+ 2^-half_range. Every quire engine, the reference quire of the Universal library included, holds
+ the same number, so the serialized form is a property of the configuration, not of the engine.
+ The image of a quire is that number in a limb_accumulator of 64-bit limbs plus the NaR flag;
+ it is taken through to_value(), which is exact, and loaded back exactly.
+
+ The wire format stores the magnitude of the image and only its significant limbs:
+
+     byte  0      'Q'
+     byte  1      flags: bit 0 NaR, bit 1 negative
+     bytes 2..7   nbits, es, capacity as 16-bit little-endian integers
+     bytes 8..11  index of the lowest stored limb and number of stored limbs, 16-bit little-endian
+     bytes 12..   the stored limbs, 64-bit little-endian, least significant first
+
+ A zero quire takes 12 bytes, and the sum of a few products of similar magnitude one or two limbs
+ more, where a posit<32,2> quire occupies eight limbs. Serialized quires of the same configuration
+ merge exactly, so partial dot products of different processes reduce to a bitwise reproducible total.
+ */
+
+// thrown when a serialized quire is malformed or of a different configuration
+class quire_format_exception : public std::runtime_error {
+public:
+	quire_format_exception(const std::string& msg) : std::runtime_error("serialized quire: " + msg) {}
+};
+
+// configuration of a quire engine
+template<typename Quire>
+struct quire_configuration;
+template<size_t nbits_, size_t es_, size_t capacity_>
+struct quire_configuration< sw::universal::quire<nbits_, es_, capacity_> > {
+	static constexpr size_t nbits = nbits_, es = es_, capacity = capacity_;
+};
+template<size_t nbits_, size_t es_, size_t capacity_>
+struct quire_configuration< lut_quire<nbits_, es_, capacity_> > {
+	static constexpr size_t nbits = nbits_, es = es_, capacity = capacity_;
+};
+template<size_t nbits_, size_t es_, size_t capacity_>
+struct quire_configuration< limb_quire<nbits_, es_, capacity_> > {
+	static constexpr size_t nbits = nbits_, es = es_, capacity = capacity_;
+};
+template<size_t nbits_, size_t es_, size_t capacity_, size_t K>
+struct quire_configuration< carry_save_quire<nbits_, es_, capacity_, K> > {
+	static constexpr size_t nbits = nbits_, es = es_, capacity = capacity_;
+};
+
+// fixed-point image of a quire<nbits, es, capacity>
+template<size_t nbits, size_t es, size_t capacity>
+struct quire_image {
+	static constexpr size_t half_range = 2 * (nbits - 2) * (size_t(1) << es);
+	static constexpr size_t qbits = 2 * half_range + capacity;
+	using Accumulator = limb_accumulator<(qbits + 1 + 63) / 64>;
+	using Reference = sw::universal::quire<nbits, es, capacity>;
+
+	Accumulator acc;
+	bool nar = false;
+
+	quire_image& operator+=(const quire_image& rhs) { acc += rhs.acc; nar |= rhs.nar; return *this; }
+	bool iszero() const { return acc.iszero() && !nar; }
+	auto to_value() const { return accumulator_to_value<Reference>(acc, int(half_range), nar); }
+};
+template<typename Quire>
+using quire_image_t = quire_image<quire_configuration<Quire>::nbits, quire_configuration<Quire>::es, quire_configuration<Quire>::capacity>;
+
+// image of the exact value v, of the value type produced by to_value()
+template<size_t nbits, size_t es, size_t capacity, typename Value>
+quire_image<nbits, es, capacity> value_to_image(const Value& v) {
+	using Image = quire_image<nbits, es, capacity>;
+	Image image;
+	if (v.isnan() || v.isinf()) {
+		image.nar = true;
+		return image;
+	}
+	if (v.iszero()) return image;
+	auto fraction = v.fraction();
+	int msb = v.scale() + int(Image::half_range);
+	if (msb < 0 || msb >= int(Image::Accumulator::nrBits) - 1) throw quire_format_exception("value exceeds the quire range");
+	auto setbit = [&](int i) { image.acc.setlimb(size_t(i) >> 6, image.acc.limb(size_t(i) >> 6) | (uint64_t(1) << (i & 63))); };
+	setbit(msb);
+	for (int i = msb - 1, f = int(fraction.size()) - 1; i >= 0 && f >= 0; --i, --f) {
+		if (fraction.test(size_t(f))) setbit(i);
+	}
+	if (v.sign()) image.acc.negate();
+	return image;
+}
+
+// exact image of a quire
+template<typename Quire>
+quire_image_t<Quire> make_quire_image(const Quire& q) {
+	using C = quire_configuration<Quire>;
+	return value_to_image<C::nbits, C::es, C::capacity>(q.to_value());
+}
+
+// load an image into a quire, replacing its content
+template<size_t nbits, size_t es, size_t capacity>
+void load_quire_image(lut_quire<nbits, es, capacity>& q, const quire_image<nbits, es, capacity>& image) { q.load(image.acc, image.nar); }
+template<size_t nbits, size_t es, size_t capacity>
+void load_quire_image(limb_quire<nbits, es, capacity>& q, const quire_image<nbits, es, capacity>& image) { q.load(image.acc, image.nar); }
+template<size_t nbits, size_t es, size_t capacity, size_t K>
+void load_quire_image(carry_save_quire<nbits, es, capacity, K>& q, const quire_image<nbits, es, capacity>& image) { q.load(image.acc, image.nar); }
+// The reference quire accepts values of scale up to half_range only. The magnitude is split into
+// A * 2^capacity + B: A is loaded into a quire that is doubled capacity times, and B is added to it.
+template<size_t nbits, size_t es, size_t capacity>
+void load_quire_image(sw::universal::quire<nbits, es, capacity>& q, const quire_image<nbits, es, capacity>& image) {
+	using Image = quire_image<nbits, es, capacity>;
+	q.clear();
+	if (image.nar) {
+		sw::universal::posit<nbits, es> nar;
+		nar.setnar();
+		q += nar;
+		return;
+	}
+	if (image.acc.iszero()) return;
+	typename Image::Accumulator magnitude = image.acc;
+	bool negative = magnitude.isneg();
+	if (negative) magnitude.negate();
+	Image high, low;
+	for (size_t i = 0; i < capacity; ++i) {
+		if (magnitude.test(i)) low.acc.add(1, i);
+	}
+	for (size_t i = capacity; i < Image::Accumulator::nrBits; ++i) {
+		if (magnitude.test(i)) high.acc.add(1, i - capacity);
+	}
+	if (negative) {
+		high.acc.negate();
+		low.acc.negate();
+	}
+	if (!high.acc.iszero()) {
+		q += high.to_value();
+		for (size_t i = 0; i < capacity; ++i) {
+			sw::universal::quire<nbits, es, capacity> doubled = q;
+			q += doubled;
+		}
+	}
+	if (!low.acc.iszero()) q += low.to_value();
+}
+
+namespace detail {
+
+constexpr size_t quire_header_size = 12;
+
+inline void put_le(std::vector<uint8_t>& bytes, uint64_t v, size_t nrBytes) {
+	for (size_t i = 0; i < nrBytes; ++i) bytes.push_back(uint8_t(v >> (8 * i)));
+}
+inline uint64_t get_le(const uint8_t* p, size_t nrBytes) {
+	uint64_t v = 0;
+	for (size_t i = 0; i < nrBytes; ++i) v |= uint64_t(p[i]) << (8 * i);
+	return v;
+}
+
+} // namespace detail
+
+// compact binary form of a quire image
+template<size_t nbits, size_t es, size_t capacity>
+std::vector<uint8_t> serialize(const quire_image<nbits, es, capacity>& image) {
+	using Image = quire_image<nbits, es, capacity>;
+	typename Image::Accumulator magnitude = image.acc;
+	bool negative = magnitude.isneg();
+	if (negative) magnitude.negate();
+	size_t lo = 0, hi = 0;      // stored limbs [lo, hi)
+	if (!image.nar && !magnitude.iszero()) {
+		hi = Image::Accumulator::nrLimbs;
+		while (magnitude.limb(hi - 1) == 0) --hi;
+		while (magnitude.limb(lo) == 0) ++lo;
+	}
+	std::vector<uint8_t> bytes;
+	bytes.reserve(detail::quire_header_size + 8 * (hi - lo));
+	bytes.push_back(uint8_t('Q'));
+	bytes.push_back(uint8_t((image.nar ? 1 : 0) | (negative && !image.nar ? 2 : 0)));
+	detail::put_le(bytes, nbits, 2);
+	detail::put_le(bytes, es, 2);
+	detail::put_le(bytes, capacity, 2);
+	detail::put_le(bytes, lo, 2);
+	detail::put_le(bytes, hi - lo, 2);
+	for (size_t i = lo; i < hi; ++i) detail::put_le(bytes, magnitude.limb(i), 8);
+	return bytes;
+}
+// compact binary form of a quire
+template<typename Quire>
+std::vector<uint8_t> serialize_quire(const Quire& q) {
+	return serialize(make_quire_image(q));
+}
+
+// image of a serialized quire<nbits, es, capacity>
+template<size_t nbits, size_t es, size_t capacity>
+quire_image<nbits, es, capacity> deserialize_image(const uint8_t* bytes, size_t size) {
+	using Image = quire_image<nbits, es, capacity>;
+	if (size < detail::quire_header_size || bytes[0] != uint8_t('Q')) throw quire_format_exception("missing header");
+	if (detail::get_le(bytes + 2, 2) != nbits || detail::get_le(bytes + 4, 2) != es || detail::get_le(bytes + 6, 2) != capacity) {
+		throw quire_format_exception("configuration mismatch");
+	}
+	size_t lo = size_t(detail::get_le(bytes + 8, 2));
+	size_t count = size_t(detail::get_le(bytes + 10, 2));
+	if (lo + count > Image::Accumulator::nrLimbs || size != detail::quire_header_size + 8 * count) throw quire_format_exception("invalid limb range");
+	Image image;
+	image.nar = (bytes[1] & 1) != 0;
+	for (size_t i = 0; i < count; ++i) image.acc.setlimb(lo + i, detail::get_le(bytes + detail::quire_header_size + 8 * i, 8));
+	if (image.acc.isneg()) throw quire_format_exception("magnitude exceeds the quire");
+	if (bytes[1] & 2) image.acc.negate();
+	return image;
+}
+template<typename Quire>
+Quire deserialize_quire(const uint8_t* bytes, size_t size) {
+	using C = quire_configuration<Quire>;
+	Quire q;
+	load_quire_image(q, deserialize_image<C::nbits, C::es, C::capacity>(bytes, size));
+	return q;
+}
+template<typename Quire>
+Quire deserialize_quire(const std::vector<uint8_t>& bytes) {
+	return deserialize_quire<Quire>(bytes.data(), bytes.size());
+}
+
+// add a serialized quire exactly into a quire
+template<typename Quire>
+void merge_serialized(Quire& q, const std::vector<uint8_t>& bytes) {
+	using C = quire_configuration<Quire>;
+	auto image = make_quire_image(q);
+	image += deserialize_image<C::nbits, C::es, C::capacity>(bytes.data(), bytes.size());
+	load_quire_image(q, image);
+}
+// exact sum of two serialized quires of the same configuration, without instantiating a quire engine
+template<size_t nbits, size_t es, size_t capacity>
+std::vector<uint8_t> merge_serialized(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+	auto image = deserialize_image<nbits, es, capacity>(a.data(), a.size());
+	image += deserialize_image<nbits, es, capacity>(b.data(), b.size());
+	return serialize(image);
+}
+// exact sum of a set of serialized quires, merged pairwise as a tree
+template<size_t nbits, size_t es, size_t capacity>
+std::vector<uint8_t> reduce_serialized(std::vector< std::vector<uint8_t> > parts) {
+	if (parts.empty()) return serialize(quire_image<nbits, es, capacity>());
+	for (size_t stride = 1; stride < parts.size(); stride *= 2) {
+		for (size_t i = 0; i + stride < parts.size(); i += 2 * stride) {
+			parts[i] = merge_serialized<nbits, es, capacity>(parts[i], parts[i + stride]);
+		}
+	}
+	return parts[0];
+}
+
+// Binary tree reduction over nrRanks participants: rank r merges the quires of ranks 2r + 1 and 2r + 2
+// into its own and passes the result to rank (r - 1) / 2. receive(child) returns the serialized quire
+// sent by a child rank, send(parent, bytes) delivers the serialized partial sum to the parent rank.
+// Rank 0 returns the exact total; the other ranks return their partial sums.
+template<typename Quire, typename Receive, typename Send>
+Quire tree_reduce(size_t rank, size_t nrRanks, const Quire& local, Receive receive, Send send) {
+	using C = quire_configuration<Quire>;
+	auto image = make_quire_image(local);
+	for (size_t child = 2 * rank + 1; child <= 2 * rank + 2 && child < nrRanks; ++child) {
+		std::vector<uint8_t> bytes = receive(child);
+		image += deserialize_image<C::nbits, C::es, C::capacity>(bytes.data(), bytes.size());
+	}
+	if (rank > 0) send((rank - 1) / 2, serialize(image));
+	Quire q;
+	load_quire_image(q, image);
+	return q;
+}
+
+#if HPRBLAS_POSIX_QUIRE_TRANSPORT
+// message framing of serialized quires over pipes and sockets: a 32-bit little-endian length and the bytes
+inline void write_quire_message(int fd, const std::vector<uint8_t>& bytes) {
+	std::vector<uint8_t> message;
+	detail::put_le(message, bytes.size(), 4);
+	message.insert(message.end(), bytes.begin(), bytes.end());
+	size_t written = 0;
+	while (written < message.size()) {
+		ssize_t n = ::write(fd, message.data() + written, message.size() - written);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) throw std::runtime_error("write_quire_message: write failed");
+		written += size_t(n);
+	}
+}
+inline std::vector<uint8_t> read_quire_message(int fd) {
+	auto read_exactly = [fd](uint8_t* p, size_t size) {
+		size_t done = 0;
+		while (done < size) {
+			ssize_t n = ::read(fd, p + done, size - done);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) throw std::runtime_error("read_quire_message: read failed");
+			done += size_t(n);
+		}
+	};
+	uint8_t length[4];
+	read_exactly(length, 4);
+	std::vector<uint8_t> bytes(size_t(detail::get_le(length, 4)));
+	read_exactly(bytes.data(), bytes.size());
+	return bytes;
+}
+#endif
+
+}} // namespace sw::hprblas
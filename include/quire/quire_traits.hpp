@@ -0,0 +1,155 @@
+#pragma once
+// quire_traits.hpp: selection of the accumulator used by the fused kernels
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <bit>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <universal/number/posit/posit.hpp>
+#include <quire/lut_quire.hpp>
+#include <quire/limb_quire.hpp>
+#include <quire/carry_save_quire.hpp>
+
+////////////////////////////////////////////////////////////////////////////////////////
+// HPRBLAS_REFERENCE_QUIRE
+// set to 1 to force all fused kernels to accumulate in sw::universal::quire
+// the native engines are also disabled when HPRBLAS_TRACE_ROUNDING_EVENTS is set,
+// as the tracing code inspects the reference quire
+// #define HPRBLAS_REFERENCE_QUIRE 0
+
+////////////////////////////////////////////////////////////////////////////////////////
+// HPRBLAS_CARRY_SAVE_QUIRE
+// set to 1 to select carry_save_quire, which defers carry propagation, for posit<16,1>,
+// posit<32,2>, and the kernels that consume decoded posit panels
+// #define HPRBLAS_CARRY_SAVE_QUIRE 0
+
+namespace sw {
+namespace hprblas {
+
+// element type classification of the reproducible kernels
+template<typename T>
+struct is_posit : std::false_type {};
+template<size_t nbits, size_t es>
+struct is_posit< sw::universal::posit<nbits, es> > : std::true_type {};
+template<typename T>
+constexpr bool is_posit_v = is_posit<T>::value;
+
+template<typename T>
+constexpr bool is_ieee_binary_v = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+template<typename T>
+struct is_complex_posit : std::false_type {};
+template<size_t nbits, size_t es>
+struct is_complex_posit< std::complex< sw::universal::posit<nbits, es> > > : std::true_type {};
+template<typename T>
+constexpr bool is_complex_posit_v = is_complex_posit<T>::value;
+
+// fused_quire selects the accumulator of the fused kernels for a posit configuration.
+// The default is the reference quire of the Universal library; specializations select
+// native engines that produce bitwise identical results.
+template<size_t nbits, size_t es, size_t capacity>
+struct fused_quire {
+	using type = sw::universal::quire<nbits, es, capacity>;
+};
+
+#if HPRBLAS_REFERENCE_QUIRE || HPRBLAS_TRACE_ROUNDING_EVENTS
+constexpr bool native_quire_engines = false;
+#else
+constexpr bool native_quire_engines = true;
+#endif
+
+#if !HPRBLAS_REFERENCE_QUIRE && !HPRBLAS_TRACE_ROUNDING_EVENTS
+template<size_t capacity>
+struct fused_quire<8, 0, capacity> {
+	using type = lut_quire<8, 0, capacity>;
+};
+#if HPRBLAS_CARRY_SAVE_QUIRE
+template<size_t capacity>
+struct fused_quire<16, 1, capacity> {
+	using type = carry_save_quire<16, 1, capacity>;
+};
+template<size_t capacity>
+struct fused_quire<32, 2, capacity> {
+	using type = carry_save_quire<32, 2, capacity>;
+};
+#else
+template<size_t capacity>
+struct fused_quire<16, 1, capacity> {
+	using type = lut_quire<16, 1, capacity>;
+};
+template<size_t capacity>
+struct fused_quire<32, 2, capacity> {
+	using type = limb_quire<32, 2, capacity>;
+};
+#endif
+#endif
+
+// capacity = 30 is the default capacity of sw::universal::quire
+template<size_t nbits, size_t es, size_t capacity = 30>
+using fused_quire_t = typename fused_quire<nbits, es, capacity>::type;
+
+// A quire<nbits, es, capacity> holds values below 2^(half_range + capacity), and every product of two posits
+// is at most maxpos^2 = 2^half_range, so it accumulates 2^capacity - 1 products without the risk of overflow.
+
+// smallest capacity that guarantees that n products cannot overflow the quire
+constexpr size_t quire_capacity_for(size_t n) { return size_t(std::bit_width(n)); }
+// largest number of products a quire with the given capacity is guaranteed to hold
+constexpr size_t quire_max_products(size_t capacity) {
+	return (capacity >= size_t(std::numeric_limits<size_t>::digits) ? std::numeric_limits<size_t>::max() : (size_t(1) << capacity) - 1);
+}
+
+// thrown when the number of products of a call exceeds the capacity of the quire chosen for it
+class quire_capacity_exception : public std::runtime_error {
+public:
+	quire_capacity_exception(size_t nrProducts, size_t capacity)
+		: std::runtime_error("quire capacity of " + std::to_string(capacity) + " bits cannot hold " + std::to_string(nrProducts) + " products"),
+		  _nrProducts(nrProducts), _capacity(capacity) {}
+	size_t products() const { return _nrProducts; }
+	size_t capacity() const { return _capacity; }
+private:
+	size_t _nrProducts;
+	size_t _capacity;
+};
+
+// The L2 and L3 kernels decode reused operands into posit panels when the posit fits a 32-bit lane.
+// posit<8,0> is served better by its product table.
+template<size_t nbits, size_t es>
+constexpr bool use_decoded_panels = native_quire_engines && nbits > 8 && nbits <= 32;
+
+// panel_quire selects the accumulator that consumes decoded posit panels
+template<size_t nbits, size_t es, size_t capacity>
+struct panel_quire {
+#if HPRBLAS_CARRY_SAVE_QUIRE
+	using type = carry_save_quire<nbits, es, capacity>;
+#else
+	using type = limb_quire<nbits, es, capacity>;
+#endif
+};
+template<size_t nbits, size_t es, size_t capacity = 30>
+using panel_quire_t = typename panel_quire<nbits, es, capacity>::type;
+
+// quire_fma accumulates the exact product a * b into a quire
+template<size_t nbits, size_t es, size_t capacity>
+inline void quire_fma(sw::universal::quire<nbits, es, capacity>& q, const sw::universal::posit<nbits, es>& a, const sw::universal::posit<nbits, es>& b) {
+	q += sw::universal::quire_mul(a, b);
+}
+template<size_t nbits, size_t es, size_t capacity>
+inline void quire_fma(lut_quire<nbits, es, capacity>& q, const sw::universal::posit<nbits, es>& a, const sw::universal::posit<nbits, es>& b) {
+	q.fma(a, b);
+}
+template<size_t nbits, size_t es, size_t capacity>
+inline void quire_fma(limb_quire<nbits, es, capacity>& q, const sw::universal::posit<nbits, es>& a, const sw::universal::posit<nbits, es>& b) {
+	q.fma(a, b);
+}
+template<size_t nbits, size_t es, size_t capacity, size_t K>
+inline void quire_fma(carry_save_quire<nbits, es, capacity, K>& q, const sw::universal::posit<nbits, es>& a, const sw::universal::posit<nbits, es>& b) {
+	q.fma(a, b);
+}
+
+}} // namespace sw::hprblas
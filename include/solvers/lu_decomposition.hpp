@@ -9,6 +9,7 @@
 #define POSIT_VERBOSE_OUTPUT
 #define QUIRE_TRACE_ADD
 #include <universal/number/posit/posit.hpp>
+#include <quire/quire_traits.hpp>
 
 namespace sw {
 namespace hprblas {
@@ -92,10 +93,10 @@ void CroutFDP(mtl::dense2D< sw::universal::posit<nbits, es> >& S, mtl::dense2D<
 	using namespace sw::universal;
 	for (int k = 0; k < d; ++k) {
 		for (int i = k; i < d; ++i) {
-			quire<nbits, es, capacity> q;
+			fused_quire_t<nbits, es, capacity> q;
 			q.reset();
 			//for (int p = 0; p < k; ++p) q += D[i][p] * D[p][k];   if we had expression templates for the quire
-			for (int p = 0; p < k; ++p) q += quire_mul(D[i][p], D[p][k]);
+			for (int p = 0; p < k; ++p) quire_fma(q, D[i][p], D[p][k]);
 			posit<nbits, es> sum;
 			convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
 			// TODO: can we add the difference to the quire operation?
@@ -112,10 +113,10 @@ void CroutFDP(mtl::dense2D< sw::universal::posit<nbits, es> >& S, mtl::dense2D<
 #endif
 		}
 		for (int j = k + 1; j < d; ++j) {
-			quire<nbits, es, capacity> q;
+			fused_quire_t<nbits, es, capacity> q;
 			q.reset();
 			//for (int p = 0; p < k; ++p) q += D[k][p] * D[p][j];   if we had expression templates for the quire
-			for (int p = 0; p < k; ++p) q += quire_mul(D[k][p], D[p][j]);
+			for (int p = 0; p < k; ++p) quire_fma(q, D[k][p], D[p][j]);
 			posit<nbits, es> sum;
 			convert(q.to_value(), sum);   // one and only rounding step of the fused-dot product
 			D[k][j] = (S[k][j] - sum) / D[k][k];
@@ -143,19 +144,19 @@ void SolveCroutFDP(const mtl::dense2D< sw::universal::posit<nbits, es> >& LU, co
 	size_t d = size(b);
 	std::vector< posit<nbits, es> > y(d);
 	for (long i = 0; i < d; ++i) {
-		quire<nbits, es, capacity> q;
+		fused_quire_t<nbits, es, capacity> q;
 		// for (int k = 0; k < i; ++k) q += LU[i][k] * y[k];   if we had expression templates for the quire
-		for (int k = 0; k < i; ++k) q += quire_mul(LU[i][k], y[k]);
+		for (int k = 0; k < i; ++k) quire_fma(q, LU[i][k], y[k]);
 		posit<nbits, es> sum;
 		convert(q.to_value(), sum);   // one and only rounding step of the fused-dot product
 		y[i] = (b[i] - sum) / LU[i][i];
 	}
 	for (long i = long(d) - 1; i >= 0; --i) {
-		quire<nbits, es, capacity> q;
+		fused_quire_t<nbits, es, capacity> q;
 		// for (int k = i + 1; k < d; ++k) q += LU[i][k] * x[k];   if we had expression templates for the quire
 		for (int k = i + 1; k < d; ++k) {
 			//cout << "lu[] = " << LU[i][k] << " x[" << k << "] = " << x[k] << endl;
-			q += quire_mul(LU[i][k], x[k]);
+			quire_fma(q, LU[i][k], x[k]);
 		}
 		posit<nbits, es> sum;
 		convert(q.to_value(), sum);  // one and only rounding step of the fused-dot product
@@ -0,0 +1,192 @@
+#pragma once
+// statistics.hpp : single-pass moments and norms of posit vectors using the quire
+//
+// Copyright (C) 2017-2021 Stillwater Supercomputing, Inc.
+//
+// This file is part of the HPRBLAS project, which is released under an MIT Open Source license.
+
+/*
+The statistics kernel reads a vector once and accumulates the sum, the sum of magnitudes, and the
+sum of squares of its elements in three quires, while the smallest and the largest element are
+tracked by comparing encodings: posits order like two's complement integers, which flipping the
+sign bit turns into an unsigned order. Blocks of the vector are reduced in parallel and merged
+exactly, so every result is identical for any thread count.
+
+sum, l1 and the sum of squares are rounded once, and l2 rounds once more in the square root.
+The element count may exceed the range of small posits, so the mean divides the exact sum by the
+count at the precision of the quire value, with a sticky bit for the remainder, and rounds the
+quotient once to the posit. The variance is the exact second moment about that mean, which the
+quire evaluates from the sums without a second pass, and is divided by the count in the same way,
+so it rounds once as well. A NaR element makes every result NaR.
+*/
+
+namespace sw {
+namespace hprblas {
+
+// moments and norms of a vector
+template<typename Scalar>
+struct vector_statistics {
+	size_t count = 0;
+	Scalar sum = 0;
+	Scalar mean = 0;
+	Scalar variance = 0;    // population variance, the second moment about the mean divided by count
+	Scalar min = 0;
+	Scalar max = 0;
+	Scalar l1 = 0;
+	Scalar l2 = 0;
+	Scalar linf = 0;
+};
+
+// the exact value v divided by n, as a value whose rounding to a posit is the rounding of the exact quotient:
+// the significand of v is divided in 64-bit limbs with 64 guard bits, and the remainder, together with the
+// quotient bits that do not fit the fraction, sets the lowest fraction bit as a sticky bit. The fraction of
+// a quire value is far wider than any posit, so that bit lies below the rounding position.
+template<typename Value>
+Value divide_by_count(const Value& v, size_t n) {
+	if (v.iszero() || n == 1) return v;
+	auto fraction = v.fraction();
+	size_t fbits = fraction.size();
+	// significand 1.f * 2^(fbits + 64), least significant limb first
+	std::vector<uint64_t> limb((fbits + 1 + 64 + 63) / 64, 0);
+	auto set = [&](size_t bit) { limb[bit >> 6] |= uint64_t(1) << (bit & 63); };
+	set(64 + fbits);
+	for (size_t f = 0; f < fbits; ++f) if (fraction.test(f)) set(64 + f);
+	unsigned __int128 remainder = 0;
+	for (size_t i = limb.size(); i-- > 0; ) {
+		unsigned __int128 w = (remainder << 64) | limb[i];
+		limb[i] = uint64_t(w / n);
+		remainder = w % n;
+	}
+	// the quotient is at least 2^(fbits + 64) / n > 2^fbits, so its leading bit is at or above bit fbits
+	size_t msb = 0;
+	for (size_t i = limb.size(); i-- > 0; ) {
+		if (limb[i]) { msb = 64 * i + 63 - size_t(std::countl_zero(limb[i])); break; }
+	}
+	auto test = [&](size_t bit) { return ((limb[bit >> 6] >> (bit & 63)) & 1) != 0; };
+	decltype(fraction) quotient;
+	for (size_t f = 0; f < fbits; ++f) if (test(msb - fbits + f)) quotient.set(f);
+	bool sticky = (remainder != 0);
+	for (size_t bit = 0; bit < msb - fbits && !sticky; ++bit) sticky = test(bit);
+	if (sticky) quotient.set(0);
+	Value result;
+	result.set(v.sign(), v.scale() + int(msb) - int(fbits + 64), quotient, false, false);
+	return result;
+}
+
+// per-block state of the statistics kernel, merged exactly across blocks
+template<size_t nbits, size_t es>
+class statistics_accumulator {
+public:
+	using Scalar = sw::universal::posit<nbits, es>;
+	using Quire = fused_quire_t<nbits, es>;
+
+	statistics_accumulator& operator+=(const Scalar& v) {
+		if (is_nar_bits(v)) { _nar = true; return *this; }
+		uint64_t k = key(v);
+		if (_count == 0 || k < _minKey) { _minKey = k; _min = v; }
+		if (_count == 0 || k > _maxKey) { _maxKey = k; _max = v; }
+		++_count;
+		_sum += v;
+		_asum += (v < 0 ? -v : v);
+		quire_fma(_sumsq, v, v);
+		return *this;
+	}
+	statistics_accumulator& operator+=(const statistics_accumulator& rhs) {
+		_nar |= rhs._nar;
+		if (rhs._count > 0) {
+			if (_count == 0 || rhs._minKey < _minKey) { _minKey = rhs._minKey; _min = rhs._min; }
+			if (_count == 0 || rhs._maxKey > _maxKey) { _maxKey = rhs._maxKey; _max = rhs._max; }
+		}
+		_count += rhs._count;
+		_sum += rhs._sum;
+		_asum += rhs._asum;
+		_sumsq += rhs._sumsq;
+		return *this;
+	}
+
+	vector_statistics<Scalar> value() const {
+		vector_statistics<Scalar> s;
+		s.count = _count;
+		if (_nar) {
+			Scalar nar;
+			nar.setnar();
+			s.sum = s.mean = s.variance = s.min = s.max = s.l1 = s.l2 = s.linf = nar;
+			return s;
+		}
+		if (_count == 0) return s;
+		sw::universal::convert(_sum.to_value(), s.sum);     // one and only rounding step of the sum
+		sw::universal::convert(_asum.to_value(), s.l1);     // one and only rounding step of the l1-norm
+		Scalar sumsq;
+		sw::universal::convert(_sumsq.to_value(), sumsq);   // first rounding step of the l2-norm
+		s.l2 = sqrt(sumsq);                                  // second rounding step of the l2-norm
+		s.min = _min;
+		s.max = _max;
+		s.linf = (-_min > _max ? -_min : _max);
+		sw::universal::convert(divide_by_count(_sum.to_value(), _count), s.mean);                   // one and only rounding step of the mean
+		sw::universal::convert(divide_by_count(second_moment(s.mean).to_value(), _count), s.variance);  // one and only rounding step of the variance
+		return s;
+	}
+
+private:
+	Quire _sum, _asum, _sumsq;
+	Scalar _min, _max;
+	uint64_t _minKey = 0, _maxKey = 0;
+	size_t _count = 0;
+	bool _nar = false;
+
+	// unsigned key that orders posits like their values
+	static uint64_t key(const Scalar& v) { return posit_bits(v) ^ (uint64_t(1) << (nbits - 1)); }
+
+	// the posit of largest magnitude that does not exceed the exact value of q in magnitude, with the sign of q
+	// rounding to nearest can pick the encoding above a value near minpos, so such a rounding is stepped back
+	static Scalar truncated(const Quire& q) {
+		constexpr uint64_t mask = (nbits == 64 ? ~uint64_t(0) : ((uint64_t(1) << nbits) - 1));
+		Scalar p;
+		sw::universal::convert(q.to_value(), p);
+		if (p.iszero()) return p;
+		Quire over = q;
+		over += -p;                                           // q - p, exact
+		Scalar d;
+		sw::universal::convert(over.to_value(), d);
+		if (!d.iszero() && ((d < 0) != (p < 0))) {
+			// one encoding toward zero: posits order like two's complement integers
+			p.setbits((posit_bits(p) + (p < 0 ? uint64_t(1) : mask)) & mask);
+		}
+		return p;
+	}
+
+	// sum of (x - m)^2 = sumsq - 2 m sum + count m^2. The exact sum is peeled into posits p_k, each the truncation
+	// toward zero of what is left of it, so that every product m p_k is exact in the quire. What is left keeps its
+	// sign and loses at least minpos, of which every posit, and thus the sum, is a multiple, so the peeling ends at zero.
+	Quire second_moment(const Scalar& m) const {
+		Quire q = _sumsq;
+		Quire left = _sum;
+		for (Scalar p = truncated(left); !p.iszero(); p = truncated(left)) {
+			quire_fma(q, -m, p);
+			quire_fma(q, -m, p);
+			left += -p;
+		}
+		// count * m^2 by binary doubling of m^2, exact in the quire
+		Quire square, term;
+		quire_fma(square, m, m);
+		for (size_t c = _count; c > 0; c >>= 1) {
+			if (c & 1) term += square;
+			Quire doubled = square;
+			square += doubled;
+		}
+		q += term;
+		return q;
+	}
+};
+
+// sum, mean, population variance, min, max, and the l1, l2, and linf norms of a posit vector in one pass
+// nrThreads = 0 selects the size of the default thread pool
+template<size_t nbits, size_t es>
+vector_statistics< sw::universal::posit<nbits, es> > statistics(const mtl::vec::dense_vector< sw::universal::posit<nbits, es> >& v, size_t nrThreads = 0) {
+	using Scalar = sw::universal::posit<nbits, es>;
+	auto identity = [](const Scalar& x) { return x; };
+	return reproducible_reduce< statistics_accumulator<nbits, es> >(size(v), v, 1, nrThreads, identity).value();
+}
+
+} // namespace hprblas
+} // namespace sw